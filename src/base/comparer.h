@@ -1,6 +1,8 @@
 #ifndef BASE_COMPARER_H
 #define BASE_COMPARER_H
 
+#include <string.h>
+
 #include "base/vector.h"
 
 
@@ -13,6 +15,13 @@ class PtrIntComparer {
   }
 }; // class PtrIntComparer
 
+class CStringComparer {
+ public:
+  bool operator() (const char *u, const char *v) const {
+    return strcmp(u, v) < 0;
+  }
+}; // class CStringComparer
+
 
 template<size_t N, size_t I, typename T>
 class MetaVectorComparer {
@@ -8,5 +8,11 @@
 
 #define CHECK_GE(expected, current) assert(current >= expected)
 
+#if defined(__GNUC__)
+#define PREFETCH(address) __builtin_prefetch(address)
+#else
+#define PREFETCH(address)
+#endif
+
 
 #endif // #ifndef BASE_MACROS_H
@@ -0,0 +1,53 @@
+#include "base/mapped_file.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+
+namespace base {
+
+MappedFile::MappedFile(): data_(NULL), size_(0) {
+}
+
+MappedFile::~MappedFile() {
+  Close();
+}
+
+bool MappedFile::Open(const std::string &path, AccessPattern access_pattern) {
+  Close();
+
+  const int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0)
+    return false;
+
+  struct stat info;
+  if (fstat(fd, &info) != 0 || info.st_size == 0) {
+    close(fd);
+    return false;
+  }
+
+  void *data = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (data == MAP_FAILED)
+    return false;
+
+  // Hints are advisory, so their failures are ignored.
+  if (access_pattern == kSequentialAccess)
+    madvise(data, info.st_size, MADV_SEQUENTIAL);
+  madvise(data, info.st_size, MADV_WILLNEED);
+
+  data_ = static_cast<const char*>(data);
+  size_ = info.st_size;
+  return true;
+}
+
+void MappedFile::Close() {
+  if (data_ != NULL)
+    munmap(const_cast<char*>(data_), size_);
+  data_ = NULL;
+  size_ = 0;
+}
+
+}  // namespace base
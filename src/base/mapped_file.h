@@ -0,0 +1,45 @@
+#ifndef BASE_MAPPED_FILE_H
+#define BASE_MAPPED_FILE_H
+
+#include <string>
+
+#include "boost/utility.hpp"
+
+
+namespace base {
+
+// Read-only mapping of a whole file.
+class MappedFile: boost::noncopyable {
+ public:
+  enum AccessPattern {
+    kSequentialAccess,
+    kRandomAccess
+  }; // enum AccessPattern
+
+  MappedFile();
+
+  ~MappedFile();
+
+  // Maps the file and hints kernel to read it in. Aggressive read-ahead
+  // is requested only for kSequentialAccess. Returns false if the file
+  // can't be opened or mapped.
+  bool Open(const std::string &path, AccessPattern access_pattern);
+
+  void Close();
+
+  const char* data() const {
+    return data_;
+  }
+
+  size_t size() const {
+    return size_;
+  }
+
+ private:
+  const char *data_;
+  size_t size_;
+}; // class MappedFile
+
+}  // namespace base
+
+#endif // #ifndef BASE_MAPPED_FILE_H
@@ -0,0 +1,100 @@
+#include "base/perf_counters.h"
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+
+namespace base {
+
+#if defined(__linux__)
+
+namespace {
+
+int OpenCounter(uint32_t type, uint64_t config) {
+  struct perf_event_attr attr;
+  memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = type;
+  attr.config = config;
+  attr.disabled = 1;
+  attr.inherit = 1;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  return syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+uint64_t CacheReadMisses(uint64_t cache) {
+  return cache |
+    (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+    (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+}
+
+}  // namespace
+
+PerfCounters::PerfCounters(): available_(true) {
+  fds_[kL1DataMisses] = OpenCounter(PERF_TYPE_HW_CACHE,
+				    CacheReadMisses(PERF_COUNT_HW_CACHE_L1D));
+  fds_[kCacheMisses] = OpenCounter(PERF_TYPE_HARDWARE,
+				   PERF_COUNT_HW_CACHE_MISSES);
+  fds_[kDataTlbMisses] = OpenCounter(PERF_TYPE_HW_CACHE,
+				     CacheReadMisses(PERF_COUNT_HW_CACHE_DTLB));
+  for (int event = 0; event < kNumPerfEvents; ++event)
+    if (fds_[event] < 0)
+      available_ = false;
+}
+
+PerfCounters::~PerfCounters() {
+  for (int event = 0; event < kNumPerfEvents; ++event)
+    if (fds_[event] >= 0)
+      close(fds_[event]);
+}
+
+void PerfCounters::Start() {
+  if (!available_)
+    return;
+  for (int event = 0; event < kNumPerfEvents; ++event) {
+    ioctl(fds_[event], PERF_EVENT_IOC_RESET, 0);
+    ioctl(fds_[event], PERF_EVENT_IOC_ENABLE, 0);
+  }
+}
+
+void PerfCounters::Stop() {
+  if (!available_)
+    return;
+  for (int event = 0; event < kNumPerfEvents; ++event)
+    ioctl(fds_[event], PERF_EVENT_IOC_DISABLE, 0);
+}
+
+uint64_t PerfCounters::Get(PerfEvent event) const {
+  uint64_t value = 0;
+  if (available_ && read(fds_[event], &value, sizeof(value)) != sizeof(value))
+    value = 0;
+  return value;
+}
+
+#else  // #if defined(__linux__)
+
+PerfCounters::PerfCounters(): available_(false) {
+}
+
+PerfCounters::~PerfCounters() {
+}
+
+void PerfCounters::Start() {
+}
+
+void PerfCounters::Stop() {
+}
+
+uint64_t PerfCounters::Get(PerfEvent event) const {
+  return 0;
+}
+
+#endif  // #if defined(__linux__)
+
+}  // namespace base
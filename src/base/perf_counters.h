@@ -0,0 +1,46 @@
+#ifndef BASE_PERF_COUNTERS_H
+#define BASE_PERF_COUNTERS_H
+
+#include <stdint.h>
+
+#include "boost/utility.hpp"
+
+
+namespace base {
+
+enum PerfEvent {
+  kL1DataMisses,
+  kCacheMisses,
+  kDataTlbMisses,
+  kNumPerfEvents
+}; // enum PerfEvent
+
+// Counts hardware events of the calling thread and threads it starts
+// while counting, using perf_event_open. Counters are unavailable on
+// systems other than Linux, on machines without hardware counters and
+// when kernel forbids them (see /proc/sys/kernel/perf_event_paranoid).
+class PerfCounters: boost::noncopyable {
+ public:
+  PerfCounters();
+
+  ~PerfCounters();
+
+  bool available() const {
+    return available_;
+  }
+
+  // Resets counters and starts counting.
+  void Start();
+
+  void Stop();
+
+  uint64_t Get(PerfEvent event) const;
+
+ private:
+  int fds_[kNumPerfEvents];
+  bool available_;
+}; // class PerfCounters
+
+}  // namespace base
+
+#endif // #ifndef BASE_PERF_COUNTERS_H
@@ -0,0 +1,176 @@
+#include "base/regression_checker.h"
+
+#include <math.h>
+
+#include <algorithm>
+#include <iomanip>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "boost/math/distributions/students_t.hpp"
+#include "boost/tuple/tuple.hpp"
+#include "boost/tuple/tuple_comparison.hpp"
+
+
+namespace base {
+
+namespace {
+
+typedef boost::tuple<std::string, std::string, size_t, std::string> EntryKey;
+
+EntryKey GetKey(const ResultEntry &entry) {
+  return EntryKey(entry.sorter_, entry.type_, entry.test_size_,
+		  entry.distribution_);
+}
+
+void ComputeMeanAndVariance(const std::vector<double> &samples,
+			    double *mean, double *variance) {
+  *mean = 0.0;
+  for (size_t i = 0; i < samples.size(); ++i)
+    *mean += samples[i];
+  *mean /= samples.size();
+
+  *variance = 0.0;
+  for (size_t i = 0; i < samples.size(); ++i)
+    *variance += (samples[i] - *mean) * (samples[i] - *mean);
+  *variance /= samples.size() - 1;
+}
+
+// Returns p-value of one-sided Welch's t-test for hypothesis that
+// candidate mean is greater than baseline mean multiplied by scale, so
+// slowdowns within scale are never significant. Both sides must
+// contain at least two samples.
+double WelchTest(const std::vector<double> &baseline,
+		 const std::vector<double> &candidate, double scale) {
+  double baseline_mean, baseline_variance;
+  double candidate_mean, candidate_variance;
+  ComputeMeanAndVariance(baseline, &baseline_mean, &baseline_variance);
+  ComputeMeanAndVariance(candidate, &candidate_mean, &candidate_variance);
+  baseline_mean *= scale;
+  baseline_variance *= scale * scale;
+
+  const double baseline_error = baseline_variance / baseline.size();
+  const double candidate_error = candidate_variance / candidate.size();
+  const double error = baseline_error + candidate_error;
+  if (error == 0.0)
+    return candidate_mean > baseline_mean ? 0.0 : 1.0;
+
+  const double t = (candidate_mean - baseline_mean) / sqrt(error);
+  const double degrees_of_freedom = error * error /
+    (baseline_error * baseline_error / (baseline.size() - 1) +
+     candidate_error * candidate_error / (candidate.size() - 1));
+
+  boost::math::students_t distribution(degrees_of_freedom);
+  return boost::math::cdf(boost::math::complement(distribution, t));
+}
+
+struct Comparison {
+  const ResultEntry *baseline_;
+  const ResultEntry *candidate_;
+  double slowdown_;
+  double p_value_;
+}; // struct Comparison
+
+bool LessPValue(const Comparison &lhs, const Comparison &rhs) {
+  return lhs.p_value_ < rhs.p_value_;
+}
+
+void PrintComparison(const Comparison &comparison, std::ostream &os) {
+  const ResultEntry &previous = *comparison.baseline_;
+  const ResultEntry &current = *comparison.candidate_;
+  os << current.sorter_ << " " << current.type_ << " " <<
+    current.distribution_ << " " << current.test_size_ << ": " <<
+    previous.sorting_time_ << " -> " << current.sorting_time_ <<
+    " (+" << 100.0 * comparison.slowdown_ << "%";
+  if (previous.has_perf_events_ && current.has_perf_events_)
+    os << std::setprecision(0) <<
+      ", cache misses " << previous.cache_misses_ << " -> " <<
+      current.cache_misses_ <<
+      ", dTLB misses " << previous.data_tlb_misses_ << " -> " <<
+      current.data_tlb_misses_ << std::setprecision(6);
+}
+
+}  // namespace
+
+size_t CheckRegressions(const ResultSet &baseline, const ResultSet &candidate,
+			const RegressionCheckerOptions &options,
+			std::ostream &os) {
+  std::map<EntryKey, const ResultEntry*> baseline_entries;
+  for (size_t i = 0; i < baseline.entries_.size(); ++i)
+    baseline_entries[GetKey(baseline.entries_[i])] = &baseline.entries_[i];
+
+  if (baseline.metadata_.hostname_ != candidate.metadata_.hostname_)
+    os << "Warning: result sets come from different hosts: " <<
+      baseline.metadata_.hostname_ << " and " <<
+      candidate.metadata_.hostname_ << std::endl;
+
+  size_t num_unmatched = 0, num_compared = 0;
+  std::vector<Comparison> tested, untested;
+  os << std::setprecision(6) << std::fixed;
+
+  for (size_t i = 0; i < candidate.entries_.size(); ++i) {
+    const ResultEntry &current = candidate.entries_[i];
+    std::map<EntryKey, const ResultEntry*>::const_iterator it =
+      baseline_entries.find(GetKey(current));
+    if (it == baseline_entries.end()) {
+      ++num_unmatched;
+      continue;
+    }
+    const ResultEntry &previous = *it->second;
+
+    if (previous.sorting_time_ < options.min_time_ &&
+	current.sorting_time_ < options.min_time_)
+      continue;
+    ++num_compared;
+
+    Comparison comparison;
+    comparison.baseline_ = &previous;
+    comparison.candidate_ = &current;
+    comparison.slowdown_ =
+      (current.sorting_time_ - previous.sorting_time_) /
+      std::max(previous.sorting_time_, options.min_time_);
+    comparison.p_value_ = 1.0;
+
+    if (previous.sorting_times_.size() >= 2 &&
+	current.sorting_times_.size() >= 2) {
+      comparison.p_value_ = WelchTest(previous.sorting_times_,
+				      current.sorting_times_,
+				      1.0 + options.threshold_);
+      tested.push_back(comparison);
+    } else if (comparison.slowdown_ > options.threshold_) {
+      untested.push_back(comparison);
+    }
+  }
+
+  // Holm-Bonferroni correction keeps probability of any false
+  // regression among all tested entries below significance level.
+  std::sort(tested.begin(), tested.end(), LessPValue);
+  size_t num_regressions = 0;
+  while (num_regressions < tested.size() &&
+	 tested[num_regressions].p_value_ * (tested.size() - num_regressions) <
+	 options.significance_level_)
+    ++num_regressions;
+
+  for (size_t i = 0; i < num_regressions; ++i) {
+    os << "REGRESSION ";
+    PrintComparison(tested[i], os);
+    os << ", p=" << tested[i].p_value_ << ")" << std::endl;
+  }
+  for (size_t i = 0; i < untested.size(); ++i) {
+    os << "SLOWDOWN ";
+    PrintComparison(untested[i], os);
+    os << ", threshold only, untested)" << std::endl;
+  }
+
+  if (num_unmatched > 0)
+    os << "Skipped " << num_unmatched <<
+      " candidate entries without baseline" << std::endl;
+  os << "Compared " << num_compared << " entries, tested " <<
+    tested.size() << " with at least two samples on both sides, found " <<
+    num_regressions << " regressions and " << untested.size() <<
+    " untested slowdowns" << std::endl;
+  return num_regressions;
+}
+
+}  // namespace base
@@ -0,0 +1,33 @@
+#ifndef BASE_REGRESSION_CHECKER_H
+#define BASE_REGRESSION_CHECKER_H
+
+#include <ostream>
+
+#include "base/result_set.h"
+
+
+namespace base {
+
+struct RegressionCheckerOptions {
+  // Minimum relative slowdown of mean sorting time that is reported.
+  double threshold_;
+  // Family-wise significance level of one-sided Welch's t-tests for
+  // slowdowns above threshold, with Holm-Bonferroni correction over all
+  // tested entries. Entries with less than two samples on either side
+  // are reported by threshold only and aren't counted as regressions.
+  double significance_level_;
+  // Entries faster than this on both sides are too noisy to compare.
+  double min_time_;
+}; // struct RegressionCheckerOptions
+
+// Aligns entries of both result sets by (sorter, type, size,
+// distribution), writes a report to os and returns the number of
+// statistically significant regressions of candidate against baseline.
+// Candidate entries without baseline are counted in the report only.
+size_t CheckRegressions(const ResultSet &baseline, const ResultSet &candidate,
+			const RegressionCheckerOptions &options,
+			std::ostream &os);
+
+}  // namespace base
+
+#endif // #ifndef BASE_REGRESSION_CHECKER_H
@@ -0,0 +1,242 @@
+#include "base/result_set.h"
+
+#include <time.h>
+#include <unistd.h>
+
+#include <fstream>
+#include <iomanip>
+
+#define BOOST_BIND_GLOBAL_PLACEHOLDERS
+#include "boost/filesystem.hpp"
+#include "boost/foreach.hpp"
+#include "boost/property_tree/json_parser.hpp"
+#include "boost/property_tree/ptree.hpp"
+#include "boost/thread/thread.hpp"
+
+#ifndef BUILD_FLAGS
+#define BUILD_FLAGS "unknown"
+#endif
+
+
+namespace base {
+
+namespace {
+
+std::string EscapeJson(const std::string &s) {
+  std::string result;
+  for (size_t i = 0; i < s.size(); ++i) {
+    switch (s[i]) {
+    case '"': result += "\\\""; break;
+    case '\\': result += "\\\\"; break;
+    case '\n': result += "\\n"; break;
+    case '\t': result += "\\t"; break;
+    default: result += s[i];
+    }
+  }
+  return result;
+}
+
+std::string Quote(const std::string &s) {
+  return "\"" + EscapeJson(s) + "\"";
+}
+
+std::string EscapeCsv(const std::string &s) {
+  if (s.find_first_of(",\"\n") == std::string::npos)
+    return s;
+  std::string result = "\"";
+  for (size_t i = 0; i < s.size(); ++i) {
+    if (s[i] == '"')
+      result += '"';
+    result += s[i];
+  }
+  return result + "\"";
+}
+
+}  // namespace
+
+void CollectMachineMetadata(RunMetadata *metadata) {
+  char hostname[256];
+  if (gethostname(hostname, sizeof(hostname)) == 0) {
+    hostname[sizeof(hostname) - 1] = '\0';
+    metadata->hostname_ = hostname;
+  } else {
+    metadata->hostname_ = "unknown";
+  }
+
+  metadata->num_cores_ = boost::thread::hardware_concurrency();
+
+#ifdef __VERSION__
+  metadata->compiler_ = __VERSION__;
+#else
+  metadata->compiler_ = "unknown";
+#endif
+  metadata->build_flags_ = BUILD_FLAGS;
+
+  char timestamp[64];
+  time_t now = time(NULL);
+  strftime(timestamp, sizeof(timestamp), "%Y-%m-%dT%H:%M:%SZ", gmtime(&now));
+  metadata->timestamp_ = timestamp;
+}
+
+bool DumpJson(const ResultSet &result_set, const std::string &path) {
+  std::ofstream ofs(path.c_str());
+  if (!ofs)
+    return false;
+
+  const RunMetadata &metadata = result_set.metadata_;
+  ofs << std::setprecision(9);
+
+  ofs << "{" << std::endl;
+  ofs << "  \"metadata\": {" << std::endl;
+  ofs << "    \"hostname\": " << Quote(metadata.hostname_) << "," << std::endl;
+  ofs << "    \"num_cores\": " << metadata.num_cores_ << "," << std::endl;
+  ofs << "    \"compiler\": " << Quote(metadata.compiler_) << "," << std::endl;
+  ofs << "    \"build_flags\": " << Quote(metadata.build_flags_) << "," <<
+    std::endl;
+  ofs << "    \"timestamp\": " << Quote(metadata.timestamp_) << "," <<
+    std::endl;
+  ofs << "    \"seed\": " << metadata.seed_ << "," << std::endl;
+  ofs << "    \"max_power\": " << metadata.max_power_ << "," << std::endl;
+  ofs << "    \"num_repetitions\": " << metadata.num_repetitions_ << std::endl;
+  ofs << "  }," << std::endl;
+
+  ofs << "  \"results\": [";
+  for (size_t i = 0; i < result_set.entries_.size(); ++i) {
+    const ResultEntry &entry = result_set.entries_[i];
+    ofs << (i == 0 ? "" : ",") << std::endl;
+    ofs << "    {" << std::endl;
+    ofs << "      \"sorter\": " << Quote(entry.sorter_) << "," << std::endl;
+    ofs << "      \"type\": " << Quote(entry.type_) << "," << std::endl;
+    ofs << "      \"distribution\": " << Quote(entry.distribution_) << "," <<
+      std::endl;
+    ofs << "      \"test_size\": " << entry.test_size_ << "," << std::endl;
+    ofs << "      \"generating_time\": " << entry.generating_time_ << "," <<
+      std::endl;
+    ofs << "      \"sorting_time\": " << entry.sorting_time_ << "," <<
+      std::endl;
+    ofs << "      \"checking_time\": " << entry.checking_time_ << "," <<
+      std::endl;
+    ofs << "      \"sorting_times\": [";
+    for (size_t j = 0; j < entry.sorting_times_.size(); ++j)
+      ofs << (j == 0 ? "" : ", ") << entry.sorting_times_[j];
+    ofs << "]," << std::endl;
+    ofs << "      \"has_perf_events\": " <<
+      (entry.has_perf_events_ ? "true" : "false");
+    if (entry.has_perf_events_) {
+      ofs << "," << std::endl;
+      ofs << "      \"l1_data_misses\": " << entry.l1_data_misses_ << "," <<
+	std::endl;
+      ofs << "      \"cache_misses\": " << entry.cache_misses_ << "," <<
+	std::endl;
+      ofs << "      \"data_tlb_misses\": " << entry.data_tlb_misses_;
+    }
+    ofs << std::endl;
+    ofs << "    }";
+  }
+  ofs << std::endl << "  ]" << std::endl;
+  ofs << "}" << std::endl;
+
+  return ofs.good();
+}
+
+bool DumpCsv(const ResultSet &result_set, const std::string &path) {
+  std::ofstream ofs(path.c_str());
+  if (!ofs)
+    return false;
+
+  const RunMetadata &metadata = result_set.metadata_;
+  ofs << "# hostname: " << metadata.hostname_ << std::endl;
+  ofs << "# num_cores: " << metadata.num_cores_ << std::endl;
+  ofs << "# compiler: " << metadata.compiler_ << std::endl;
+  ofs << "# build_flags: " << metadata.build_flags_ << std::endl;
+  ofs << "# timestamp: " << metadata.timestamp_ << std::endl;
+  ofs << "# seed: " << metadata.seed_ << std::endl;
+  ofs << "# max_power: " << metadata.max_power_ << std::endl;
+  ofs << "# num_repetitions: " << metadata.num_repetitions_ << std::endl;
+
+  ofs << "sorter,type,distribution,test_size,"
+    "generating_time,sorting_time,checking_time,"
+    "l1_data_misses,cache_misses,data_tlb_misses,sorting_times" << std::endl;
+  ofs << std::setprecision(9);
+  for (size_t i = 0; i < result_set.entries_.size(); ++i) {
+    const ResultEntry &entry = result_set.entries_[i];
+    ofs <<
+      EscapeCsv(entry.sorter_) << ',' <<
+      EscapeCsv(entry.type_) << ',' <<
+      EscapeCsv(entry.distribution_) << ',' <<
+      entry.test_size_ << ',' <<
+      entry.generating_time_ << ',' <<
+      entry.sorting_time_ << ',' <<
+      entry.checking_time_ << ',';
+    // Misses are left empty without hardware counters.
+    if (entry.has_perf_events_)
+      ofs <<
+	entry.l1_data_misses_ << ',' <<
+	entry.cache_misses_ << ',' <<
+	entry.data_tlb_misses_ << ',';
+    else
+      ofs << ",,,";
+    for (size_t j = 0; j < entry.sorting_times_.size(); ++j)
+      ofs << (j == 0 ? "" : ";") << entry.sorting_times_[j];
+    ofs << std::endl;
+  }
+
+  return ofs.good();
+}
+
+bool LoadJson(const std::string &path, ResultSet *result_set) {
+  namespace property_tree = boost::property_tree;
+
+  boost::filesystem::path json_path(path);
+  if (boost::filesystem::is_directory(json_path))
+    json_path /= kResultsJsonFileName;
+
+  property_tree::ptree root;
+  try {
+    property_tree::read_json(json_path.string(), root);
+
+    RunMetadata &metadata = result_set->metadata_;
+    metadata.hostname_ = root.get<std::string>("metadata.hostname");
+    metadata.num_cores_ = root.get<unsigned>("metadata.num_cores");
+    metadata.compiler_ = root.get<std::string>("metadata.compiler");
+    metadata.build_flags_ = root.get<std::string>("metadata.build_flags");
+    metadata.timestamp_ = root.get<std::string>("metadata.timestamp");
+    metadata.seed_ = root.get<int>("metadata.seed");
+    metadata.max_power_ = root.get<int>("metadata.max_power");
+    metadata.num_repetitions_ = root.get<int>("metadata.num_repetitions");
+
+    result_set->entries_.clear();
+    BOOST_FOREACH(const property_tree::ptree::value_type &node,
+		  root.get_child("results")) {
+      const property_tree::ptree &result = node.second;
+
+      ResultEntry entry;
+      entry.sorter_ = result.get<std::string>("sorter");
+      entry.type_ = result.get<std::string>("type");
+      entry.distribution_ = result.get<std::string>("distribution");
+      entry.test_size_ = result.get<size_t>("test_size");
+      entry.generating_time_ = result.get<double>("generating_time");
+      entry.sorting_time_ = result.get<double>("sorting_time");
+      entry.checking_time_ = result.get<double>("checking_time");
+      BOOST_FOREACH(const property_tree::ptree::value_type &sample,
+		    result.get_child("sorting_times"))
+	entry.sorting_times_.push_back(sample.second.get_value<double>());
+
+      entry.has_perf_events_ = result.get<bool>("has_perf_events", false);
+      entry.l1_data_misses_ = entry.cache_misses_ = entry.data_tlb_misses_ =
+	0.0;
+      if (entry.has_perf_events_) {
+	entry.l1_data_misses_ = result.get<double>("l1_data_misses");
+	entry.cache_misses_ = result.get<double>("cache_misses");
+	entry.data_tlb_misses_ = result.get<double>("data_tlb_misses");
+      }
+
+      result_set->entries_.push_back(entry);
+    }
+  } catch (const property_tree::ptree_error &) {
+    return false;
+  }
+  return true;
+}
+
+}  // namespace base
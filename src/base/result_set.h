@@ -0,0 +1,60 @@
+#ifndef BASE_RESULT_SET_H
+#define BASE_RESULT_SET_H
+
+#include <string>
+#include <vector>
+
+
+namespace base {
+
+const char kResultsJsonFileName[] = "results.json";
+const char kResultsCsvFileName[] = "results.csv";
+
+struct RunMetadata {
+  std::string hostname_;
+  unsigned num_cores_;
+  std::string compiler_;
+  std::string build_flags_;
+  std::string timestamp_;
+  int seed_;
+  int max_power_;
+  int num_repetitions_;
+}; // struct RunMetadata
+
+// Measurements of a single sorter on a single input.
+struct ResultEntry {
+  std::string sorter_;
+  std::string type_;
+  std::string distribution_;
+  size_t test_size_;
+  double generating_time_;
+  double sorting_time_;
+  double checking_time_;
+  std::vector<double> sorting_times_;
+  // Average numbers of hardware events per sorting, valid only if
+  // hardware counters were available.
+  bool has_perf_events_;
+  double l1_data_misses_;
+  double cache_misses_;
+  double data_tlb_misses_;
+}; // struct ResultEntry
+
+struct ResultSet {
+  RunMetadata metadata_;
+  std::vector<ResultEntry> entries_;
+}; // struct ResultSet
+
+// Fills hostname, number of cores, compiler, build flags and timestamp.
+void CollectMachineMetadata(RunMetadata *metadata);
+
+bool DumpJson(const ResultSet &result_set, const std::string &path);
+
+bool DumpCsv(const ResultSet &result_set, const std::string &path);
+
+// Loads a result set written by DumpJson. Path may be either a file or
+// a directory containing results.json.
+bool LoadJson(const std::string &path, ResultSet *result_set);
+
+}  // namespace base
+
+#endif // #ifndef BASE_RESULT_SET_H
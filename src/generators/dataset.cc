@@ -0,0 +1,65 @@
+#include "generators/dataset.h"
+
+#include <iostream>
+
+
+namespace generators {
+
+namespace {
+
+const char kDatasetMagic[8] = { 'S', 'O', 'R', 'T', 'D', 'A', 'T', 'A' };
+const uint32_t kDatasetByteOrderMark = 0x01020304;
+const uint32_t kDatasetVersion = 1;
+
+}  // namespace
+
+void FillDatasetHeader(const std::string &type, size_t dimension,
+		       size_t count, DatasetHeader *header) {
+  memset(header, 0, sizeof(*header));
+  memcpy(header->magic_, kDatasetMagic, sizeof(kDatasetMagic));
+  header->byte_order_ = kDatasetByteOrderMark;
+  header->version_ = kDatasetVersion;
+  strncpy(header->type_, type.c_str(), sizeof(header->type_) - 1);
+  header->dimension_ = dimension;
+  header->count_ = count;
+  header->payload_size_ = 0;
+}
+
+bool CheckDatasetHeader(const DatasetHeader &header, size_t file_size) {
+  if (memcmp(header.magic_, kDatasetMagic, sizeof(kDatasetMagic)) != 0) {
+    std::clog << "CheckDatasetHeader: not a dataset" << std::endl;
+    return false;
+  }
+  if (header.byte_order_ != kDatasetByteOrderMark) {
+    std::clog << "CheckDatasetHeader: dataset was written on a machine " <<
+      "with different byte order" << std::endl;
+    return false;
+  }
+  if (header.version_ != kDatasetVersion) {
+    std::clog << "CheckDatasetHeader: unsupported version " <<
+      header.version_ << std::endl;
+    return false;
+  }
+  if (memchr(header.type_, '\0', sizeof(header.type_)) == NULL ||
+      header.payload_size_ != file_size - sizeof(header)) {
+    std::clog << "CheckDatasetHeader: corrupted header" << std::endl;
+    return false;
+  }
+  if (header.dimension_ > kMaxDatasetDimension) {
+    std::clog << "CheckDatasetHeader: unsupported dimension " <<
+      header.dimension_ << std::endl;
+    return false;
+  }
+  return true;
+}
+
+bool ReadDatasetHeader(const std::string &path, DatasetHeader *header) {
+  std::ifstream ifs(path.c_str(), std::ios::binary);
+  if (!ifs.read(reinterpret_cast<char*>(header), sizeof(*header)))
+    return false;
+
+  ifs.seekg(0, std::ios::end);
+  return CheckDatasetHeader(*header, ifs.tellg());
+}
+
+}  // namespace generators
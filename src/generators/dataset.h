@@ -0,0 +1,318 @@
+#ifndef GENERATORS_DATASET_H
+#define GENERATORS_DATASET_H
+
+#include <stdint.h>
+#include <string.h>
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "boost/utility.hpp"
+
+#include "base/mapped_file.h"
+#include "base/vector.h"
+
+
+namespace generators {
+
+const char kIntDatasetType[] = "int";
+const char kStringDatasetType[] = "string";
+// Largest vector dimension the tester can load a dataset into.
+const size_t kMaxDatasetDimension = 16;
+
+// Binary dataset is a header followed by count objects. Ints and vectors
+// of ints are stored as arrays in byte order of the writer, strings are
+// stored as zero-terminated keys one after another.
+struct DatasetHeader {
+  char magic_[8];
+  // kDatasetByteOrderMark as written by the writer.
+  uint32_t byte_order_;
+  uint32_t version_;
+  // kIntDatasetType or kStringDatasetType, zero-padded.
+  char type_[24];
+  // Number of ints in a vector, or zero for plain ints and strings.
+  uint64_t dimension_;
+  uint64_t count_;
+  // Size of data after the header in bytes.
+  uint64_t payload_size_;
+}; // struct DatasetHeader
+
+// Describes which datasets can be loaded into objects of type T.
+template<typename T>
+class DatasetTraits;
+
+template<>
+class DatasetTraits<int> {
+ public:
+  static const char* Type() {
+    return kIntDatasetType;
+  }
+
+  static size_t Dimension() {
+    return 0;
+  }
+}; // class DatasetTraits
+
+template<size_t N>
+class DatasetTraits<base::Vector<N, int> > {
+ public:
+  static const char* Type() {
+    return kIntDatasetType;
+  }
+
+  static size_t Dimension() {
+    return N;
+  }
+}; // class DatasetTraits
+
+template<typename T>
+class DatasetTraits<T*>: public DatasetTraits<T> {
+}; // class DatasetTraits
+
+template<>
+class DatasetTraits<std::string> {
+ public:
+  static const char* Type() {
+    return kStringDatasetType;
+  }
+
+  static size_t Dimension() {
+    return 0;
+  }
+}; // class DatasetTraits
+
+template<>
+class DatasetTraits<const char*>: public DatasetTraits<std::string> {
+}; // class DatasetTraits
+
+void FillDatasetHeader(const std::string &type, size_t dimension,
+		       size_t count, DatasetHeader *header);
+
+// Checks magic, version, byte order and dimension of a header from a file
+// of file_size bytes. Logs the reason of failure to clog.
+bool CheckDatasetHeader(const DatasetHeader &header, size_t file_size);
+
+// Reads and checks only the header, e.g. to find out which type to
+// load the dataset into.
+bool ReadDatasetHeader(const std::string &path, DatasetHeader *header);
+
+namespace internal {
+
+// Objects which are copied out of the mapping are read sequentially,
+// while pointees of pointers are read in order of sorting.
+template<typename T>
+base::MappedFile::AccessPattern GetAccessPattern(const T *objects) {
+  return base::MappedFile::kSequentialAccess;
+}
+
+template<typename T>
+base::MappedFile::AccessPattern GetAccessPattern(T* const *objects) {
+  return base::MappedFile::kRandomAccess;
+}
+
+// Header comes from an untrusted file, so count_ * object_size may overflow.
+inline bool HasFixedSizeObjects(const DatasetHeader &header,
+				size_t object_size) {
+  return header.payload_size_ % object_size == 0 &&
+    header.count_ == header.payload_size_ / object_size;
+}
+
+// Objects of fixed size are used right from the mapping.
+template<typename T>
+bool LoadObjects(const char *payload, const DatasetHeader &header,
+		 std::vector<T> *storage, const T **objects) {
+  if (!HasFixedSizeObjects(header, sizeof(T)))
+    return false;
+  *objects = reinterpret_cast<const T*>(payload);
+  return true;
+}
+
+// Pointers point to objects in the read-only mapping, which is safe as
+// sorters only reorder pointers and comparers only read objects.
+template<typename T>
+bool LoadObjects(const char *payload, const DatasetHeader &header,
+		 std::vector<T*> *storage, T* const **objects) {
+  if (!HasFixedSizeObjects(header, sizeof(T)))
+    return false;
+  storage->resize(header.count_);
+  for (size_t i = 0; i < header.count_; ++i)
+    (*storage)[i] = const_cast<T*>(reinterpret_cast<const T*>(payload) + i);
+  *objects = storage->empty() ? NULL : &storage->front();
+  return true;
+}
+
+// Calls callback(key, length) for every key in payload. Returns false
+// if payload doesn't hold exactly header.count_ keys.
+template<typename Callback>
+bool ForEachKey(const char *payload, const DatasetHeader &header,
+		Callback callback) {
+  const char *end = payload + header.payload_size_;
+  for (size_t i = 0; i < header.count_; ++i) {
+    const char *key_end =
+      static_cast<const char*>(memchr(payload, '\0', end - payload));
+    if (key_end == NULL)
+      return false;
+    callback(payload, key_end - payload);
+    payload = key_end + 1;
+  }
+  return payload == end;
+}
+
+class AppendString {
+ public:
+  explicit AppendString(std::vector<std::string> *storage):
+    storage_(storage) {
+  }
+
+  void operator() (const char *key, size_t length) const {
+    storage_->push_back(std::string(key, length));
+  }
+
+ private:
+  std::vector<std::string> *storage_;
+}; // class AppendString
+
+class AppendCString {
+ public:
+  explicit AppendCString(std::vector<const char*> *storage):
+    storage_(storage) {
+  }
+
+  void operator() (const char *key, size_t length) const {
+    storage_->push_back(key);
+  }
+
+ private:
+  std::vector<const char*> *storage_;
+}; // class AppendCString
+
+// std::string can't refer to the mapping, so keys are copied. Every key
+// takes at least its terminating zero, which bounds count_ before reserve.
+inline bool LoadObjects(const char *payload, const DatasetHeader &header,
+			std::vector<std::string> *storage,
+			const std::string **objects) {
+  if (header.count_ > header.payload_size_)
+    return false;
+  storage->reserve(header.count_);
+  if (!ForEachKey(payload, header, AppendString(storage)))
+    return false;
+  *objects = storage->empty() ? NULL : &storage->front();
+  return true;
+}
+
+inline bool LoadObjects(const char *payload, const DatasetHeader &header,
+			std::vector<const char*> *storage,
+			const char* const **objects) {
+  if (header.count_ > header.payload_size_)
+    return false;
+  storage->reserve(header.count_);
+  if (!ForEachKey(payload, header, AppendCString(storage)))
+    return false;
+  *objects = storage->empty() ? NULL : &storage->front();
+  return true;
+}
+
+template<typename T>
+bool WriteObjects(size_t size, const T *objects, std::ostream &os) {
+  os.write(reinterpret_cast<const char*>(objects), size * sizeof(T));
+  return true;
+}
+
+template<typename T>
+bool WriteObjects(size_t size, T* const *objects, std::ostream &os) {
+  for (size_t i = 0; i < size; ++i)
+    os.write(reinterpret_cast<const char*>(objects[i]), sizeof(T));
+  return true;
+}
+
+// Keys containing zero can't be stored.
+inline bool WriteObjects(size_t size, const std::string *objects,
+			 std::ostream &os) {
+  for (size_t i = 0; i < size; ++i) {
+    if (objects[i].find('\0') != std::string::npos)
+      return false;
+    os.write(objects[i].c_str(), objects[i].size() + 1);
+  }
+  return true;
+}
+
+inline bool WriteObjects(size_t size, const char* const *objects,
+			 std::ostream &os) {
+  for (size_t i = 0; i < size; ++i)
+    os.write(objects[i], strlen(objects[i]) + 1);
+  return true;
+}
+
+}  // namespace internal
+
+// Input loaded from a dataset file. Ints and vectors are loaded without
+// copying, but callers which sort them copy them out of the read-only
+// mapping anyway. Pointers to them and C strings are sorted with their
+// pointees left in the mapping. std::string keys are copied at load.
+template<typename T>
+class MappedDataset: boost::noncopyable {
+ public:
+  MappedDataset(): objects_(NULL), size_(0) {
+  }
+
+  // Returns false if the file can't be mapped or doesn't hold objects
+  // of type T.
+  bool Open(const std::string &path) {
+    if (!file_.Open(path, internal::GetAccessPattern(objects_)) ||
+	file_.size() < sizeof(DatasetHeader))
+      return false;
+
+    memcpy(&header_, file_.data(), sizeof(header_));
+    if (!CheckDatasetHeader(header_, file_.size()) ||
+	strcmp(header_.type_, DatasetTraits<T>::Type()) != 0 ||
+	header_.dimension_ != DatasetTraits<T>::Dimension())
+      return false;
+
+    if (!internal::LoadObjects(file_.data() + sizeof(DatasetHeader), header_,
+			       &storage_, &objects_))
+      return false;
+    size_ = header_.count_;
+    return true;
+  }
+
+  size_t size() const {
+    return size_;
+  }
+
+  // Objects are valid until the dataset is destroyed.
+  const T* objects() const {
+    return objects_;
+  }
+
+ private:
+  base::MappedFile file_;
+  DatasetHeader header_;
+  std::vector<T> storage_;
+  const T *objects_;
+  size_t size_;
+}; // class MappedDataset
+
+// Writes objects in the format read by MappedDataset.
+template<typename T>
+bool WriteDataset(const std::string &path, size_t size, const T *objects) {
+  std::ofstream ofs(path.c_str(), std::ios::binary);
+  if (!ofs)
+    return false;
+
+  DatasetHeader header;
+  FillDatasetHeader(DatasetTraits<T>::Type(), DatasetTraits<T>::Dimension(),
+		    size, &header);
+  ofs.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  if (!internal::WriteObjects(size, objects, ofs))
+    return false;
+
+  header.payload_size_ = static_cast<uint64_t>(ofs.tellp()) - sizeof(header);
+  ofs.seekp(0);
+  ofs.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  return ofs.good();
+}
+
+}  // namespace generators
+
+#endif // #ifndef GENERATORS_DATASET_H
@@ -0,0 +1,77 @@
+#ifndef GENERATORS_DISTRIBUTIONS_H
+#define GENERATORS_DISTRIBUTIONS_H
+
+#include <stdlib.h>
+
+#include <algorithm>
+#include <string>
+
+
+namespace generators {
+
+const char kRandomDistribution[] = "random";
+const char kNearlySortedDistribution[] = "nearly_sorted";
+const char kReversedDistribution[] = "reversed";
+const char kFewUniqueDistribution[] = "few_unique";
+
+const char* const kDistributions[] = {
+  kRandomDistribution,
+  kNearlySortedDistribution,
+  kReversedDistribution,
+  kFewUniqueDistribution,
+};
+
+const size_t kNumDistributions =
+  sizeof(kDistributions) / sizeof(kDistributions[0]);
+
+// Number of distinct values in few_unique inputs.
+const size_t kFewUniqueValues = 16;
+
+inline bool IsKnownDistribution(const std::string &distribution) {
+  return std::find(kDistributions, kDistributions + kNumDistributions,
+		   distribution) != kDistributions + kNumDistributions;
+}
+
+template<typename T>
+void CopyValue(const T &source, T *destination) {
+  *destination = source;
+}
+
+// Pointed objects are owned by the buffer, so values are copied instead
+// of pointers.
+template<typename T>
+void CopyValue(T *const &source, T **destination) {
+  **destination = *source;
+}
+
+// C strings are not owned by the buffer.
+inline void CopyValue(const char *const &source, const char **destination) {
+  *destination = source;
+}
+
+// Reshapes randomly generated objects into the given distribution:
+// nearly_sorted swaps 1% of random pairs in a sorted sequence, reversed
+// is sorted in descending order, few_unique copies a handful of
+// objects over the whole sequence.
+template<typename T, typename Comparer>
+void ApplyDistribution(const std::string &distribution, size_t size,
+		       T *objects) {
+  Comparer comparer;
+
+  if (distribution == kNearlySortedDistribution) {
+    std::sort(objects, objects + size, comparer);
+    for (size_t i = 0; i < size / 100; ++i)
+      std::swap(objects[rand() % size], objects[rand() % size]);
+  } else if (distribution == kReversedDistribution) {
+    std::sort(objects, objects + size, comparer);
+    std::reverse(objects, objects + size);
+  } else if (distribution == kFewUniqueDistribution) {
+    const size_t num_values = std::min(size, kFewUniqueValues);
+    for (size_t i = num_values; i < size; ++i)
+      CopyValue(objects[rand() % num_values], &objects[i]);
+  }
+}
+
+}  // namespace generators
+
+#endif // #ifndef GENERATORS_DISTRIBUTIONS_H
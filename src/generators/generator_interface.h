@@ -14,6 +14,10 @@ class GeneratorInterace: boost::noncopyable {
   virtual ~GeneratorInterace() {}
 
   virtual void Generate(T *object) = 0;
+
+  // Tells that objects generated so far are no longer used, so parts
+  // of them owned by the generator may be freed.
+  virtual void ReleaseObjects() {}
 }; // class GeneratorInterace
 
 }  // namespace generators
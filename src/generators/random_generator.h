@@ -17,6 +17,7 @@ class RandomGenerator: public GeneratorInterace<T> {
   virtual void Generate(T *object);
 }; // class RandomGenerator
 
+// Fills an object pointed by *object, which must be allocated by caller.
 template<typename T>
 class RandomGenerator<T*>: public GeneratorInterace<T*> {
  public:
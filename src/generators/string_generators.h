@@ -0,0 +1,127 @@
+#ifndef GENERATORS_STRING_GENERATORS_H
+#define GENERATORS_STRING_GENERATORS_H
+
+#include <stdlib.h>
+
+#include <deque>
+#include <string>
+#include <vector>
+
+#include "boost/scoped_ptr.hpp"
+
+#include "generators/generator_interface.h"
+
+
+namespace generators {
+
+const char kRandomStringKeys[] = "random";
+const char kSharedPrefixStringKeys[] = "shared_prefix";
+const char kDictionaryStringKeys[] = "dictionary";
+
+namespace internal {
+
+// Characters are drawn from [first .. last], which must not contain
+// zero, so keys are valid C strings.
+inline std::string RandomString(size_t min_length, size_t max_length,
+				char first, char last) {
+  std::string result(min_length + rand() % (max_length - min_length + 1), ' ');
+  for (size_t i = 0; i < result.size(); ++i)
+    result[i] = static_cast<char>(first + rand() % (last - first + 1));
+  return result;
+}
+
+}  // namespace internal
+
+// Printable keys of length from 8 to 32.
+class RandomStringGenerator: public GeneratorInterace<std::string> {
+ public:
+  virtual void Generate(std::string *s) {
+    *s = internal::RandomString(8, 32, '!', '~');
+  }
+}; // class RandomStringGenerator
+
+// URL-like keys: one of a few long hosts and paths followed by a short
+// numeric id.
+class SharedPrefixStringGenerator: public GeneratorInterace<std::string> {
+ public:
+  SharedPrefixStringGenerator() {
+    for (size_t i = 0; i < kNumPrefixes; ++i)
+      prefixes_.push_back("https://www.example.com/catalog/" +
+			  internal::RandomString(4, 12, 'a', 'z') +
+			  "/items/");
+  }
+
+  virtual void Generate(std::string *s) {
+    *s = prefixes_[rand() % kNumPrefixes] +
+      internal::RandomString(1, 10, '0', '9');
+  }
+
+ private:
+  static const size_t kNumPrefixes = 8;
+
+  std::vector<std::string> prefixes_;
+}; // class SharedPrefixStringGenerator
+
+// Composite ids of two or three words from a fixed vocabulary, where
+// words with small indices are more frequent.
+class DictionaryStringGenerator: public GeneratorInterace<std::string> {
+ public:
+  DictionaryStringGenerator() {
+    for (size_t i = 0; i < kNumWords; ++i)
+      words_.push_back(internal::RandomString(3, 10, 'a', 'z'));
+  }
+
+  virtual void Generate(std::string *s) {
+    const size_t num_words = 2 + rand() % 2;
+    s->clear();
+    for (size_t i = 0; i < num_words; ++i) {
+      if (i > 0)
+	*s += '_';
+      *s += words_[rand() % (rand() % kNumWords + 1)];
+    }
+  }
+
+ private:
+  static const size_t kNumWords = 4096;
+
+  std::vector<std::string> words_;
+}; // class DictionaryStringGenerator
+
+// Produces C strings from keys of another generator. Keys are owned by
+// the generator and stay valid until ReleaseObjects is called.
+class CStringGenerator: public GeneratorInterace<const char*> {
+ public:
+  explicit CStringGenerator(GeneratorInterace<std::string> *generator):
+    generator_(generator) {
+  }
+
+  virtual void Generate(const char **s) {
+    keys_.push_back(std::string());
+    generator_->Generate(&keys_.back());
+    *s = keys_.back().c_str();
+  }
+
+  virtual void ReleaseObjects() {
+    std::deque<std::string>().swap(keys_);
+  }
+
+ private:
+  boost::scoped_ptr<GeneratorInterace<std::string> > generator_;
+  std::deque<std::string> keys_;
+}; // class CStringGenerator
+
+// Returns NULL for unknown kind of keys.
+inline GeneratorInterace<std::string>* CreateStringGenerator(
+  const std::string &keys) {
+  if (keys == kRandomStringKeys)
+    return new RandomStringGenerator();
+  if (keys == kSharedPrefixStringKeys)
+    return new SharedPrefixStringGenerator();
+  if (keys == kDictionaryStringKeys)
+    return new DictionaryStringGenerator();
+  return NULL;
+}
+
+}  // namespace generators
+
+#endif // #ifndef GENERATORS_STRING_GENERATORS_H
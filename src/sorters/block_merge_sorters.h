@@ -0,0 +1,377 @@
+#ifndef SORTERS_BLOCK_MERGE_SORTERS_H
+#define SORTERS_BLOCK_MERGE_SORTERS_H
+
+#include <stdlib.h>
+
+#include <algorithm>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <new>
+#include <utility>
+
+#include <boost/thread/thread.hpp>
+
+#include "sorters/insertion_sorter.h"
+#include "sorters/sorter_interface.h"
+
+using std::clog;
+using std::endl;
+
+
+namespace sorters {
+
+const size_t kBlockMergeInsertionRun = 16;
+
+// Stable in-place merging with an external buffer of ceil(sqrt(n))
+// elements. Runs that don't fit into the buffer are cut into blocks
+// of ceil(sqrt(size)) elements, blocks are rearranged by their first
+// elements and then merged locally, so each merge is linear and the
+// memory footprint doesn't depend on the input.
+template<typename Iterator, typename Comparer>
+class BlockMerger {
+ public:
+  typedef typename std::iterator_traits<Iterator>::value_type Value;
+
+  // Returns ceil(sqrt(size)).
+  static size_t EstimateBufferSize(size_t size) {
+    size_t root = 0;
+    while (root * root < size)
+      ++root;
+    return root;
+  }
+
+  // Sorts objects using buffer of at least EstimateBufferSize(size)
+  // elements and labels of at least 2 * EstimateBufferSize(size)
+  // entries. Runs of run_size elements are sorted by insertion sort.
+  static void Sort(size_t size, Iterator objects, Comparer &comparer,
+		   Value *buffer, size_t *labels, size_t buffer_size,
+		   size_t run_size) {
+    for (size_t i = 0; i < size; i += run_size)
+      InsertionSort()(objects + i, objects + i + std::min(run_size, size - i),
+		      comparer);
+
+    for (size_t width = run_size; width < size; width *= 2)
+      for (size_t i = 0; i + width < size; i += 2 * width)
+	Merge(width, std::min(width, size - i - width), objects + i,
+	      comparer, buffer, labels, buffer_size);
+  }
+
+  // Merges sorted ranges [objects, objects + left_size) and
+  // [objects + left_size, objects + left_size + right_size).
+  static void Merge(size_t left_size, size_t right_size, Iterator objects,
+		    Comparer &comparer,
+		    Value *buffer, size_t *labels, size_t buffer_size) {
+    if (left_size == 0 || right_size == 0)
+      return;
+    if (!comparer(objects[left_size], objects[left_size - 1]))
+      return;
+
+    if (std::min(left_size, right_size) <= buffer_size)
+      BufferedMerge(left_size, right_size, objects, comparer, buffer);
+    else
+      BlockMerge(left_size, right_size, objects, comparer, buffer, labels);
+  }
+
+ private:
+  // Merges ranges when the smaller one fits into the buffer.
+  static void BufferedMerge(size_t left_size, size_t right_size,
+			    Iterator objects, Comparer &comparer,
+			    Value *buffer) {
+    Iterator middle = objects + left_size, end = middle + right_size;
+
+    if (left_size <= right_size) {
+      std::move(objects, middle, buffer);
+
+      Value *left = buffer, *left_end = buffer + left_size;
+      Iterator right = middle, out = objects;
+      while (left != left_end && right != end) {
+	if (comparer(*right, *left))
+	  *out++ = std::move(*right++);
+	else
+	  *out++ = std::move(*left++);
+      }
+      std::move(left, left_end, out);
+    } else {
+      std::move(middle, end, buffer);
+
+      Iterator left = middle, out = end;
+      Value *right = buffer + right_size;
+      while (left != objects && right != buffer) {
+	if (comparer(*(right - 1), *(left - 1)))
+	  *--out = std::move(*--left);
+	else
+	  *--out = std::move(*--right);
+      }
+      std::move_backward(buffer, right, out);
+    }
+  }
+
+  // Merges ranges when both of them are larger than the buffer. The
+  // left range is split into an uneven head and full blocks, the right
+  // one into full blocks and an uneven tail. Full blocks are arranged
+  // by their first elements (left blocks win ties), the tail is rotated
+  // into its place, and then neighbouring fragments of different
+  // origin are merged through the buffer until one of them runs out.
+  static void BlockMerge(size_t left_size, size_t right_size,
+			 Iterator objects, Comparer &comparer,
+			 Value *buffer, size_t *labels) {
+    const size_t block_size = EstimateBufferSize(left_size + right_size);
+    const size_t head_size = left_size % block_size;
+    const size_t left_blocks = left_size / block_size;
+    const size_t tail_size = right_size % block_size;
+    const size_t num_blocks = left_blocks + right_size / block_size;
+
+    Iterator blocks = objects + head_size;
+    Iterator tail = blocks + num_blocks * block_size;
+
+    // labels[position] is an original index of a block, positions[index]
+    // is a current position of a block. Blocks with indices less than
+    // left_blocks come from the left range.
+    size_t *positions = labels + num_blocks;
+    for (size_t i = 0; i < num_blocks; ++i)
+      labels[i] = positions[i] = i;
+
+    size_t next_left = 0, next_right = left_blocks;
+    for (size_t i = 0; i < num_blocks; ++i) {
+      size_t chosen;
+      if (next_left == left_blocks)
+	chosen = next_right++;
+      else if (next_right == num_blocks)
+	chosen = next_left++;
+      else if (comparer(blocks[positions[next_right] * block_size],
+			blocks[positions[next_left] * block_size]))
+	chosen = next_right++;
+      else
+	chosen = next_left++;
+
+      const size_t j = positions[chosen];
+      if (j != i) {
+	std::swap_ranges(blocks + i * block_size,
+			 blocks + (i + 1) * block_size,
+			 blocks + j * block_size);
+	std::swap(labels[i], labels[j]);
+	positions[labels[i]] = i;
+	positions[labels[j]] = j;
+      }
+    }
+
+    size_t tail_position = num_blocks;
+    if (tail_size > 0) {
+      while (tail_position > 0 && labels[tail_position - 1] < left_blocks &&
+	     comparer(*tail, blocks[(tail_position - 1) * block_size]))
+	--tail_position;
+      std::rotate(blocks + tail_position * block_size, tail,
+		  tail + tail_size);
+    }
+
+    Iterator pending = objects;
+    size_t pending_size = head_size;
+    bool pending_left = true;
+
+    Iterator current = blocks;
+    for (size_t i = 0; i <= num_blocks; ++i) {
+      size_t current_size = block_size;
+      bool current_left;
+      if (i < tail_position) {
+	current_left = labels[i] < left_blocks;
+      } else if (i == tail_position) {
+	if (tail_size == 0)
+	  continue;
+	current_size = tail_size;
+	current_left = false;
+      } else {
+	current_left = true;
+      }
+
+      if (current_left == pending_left) {
+	pending = current;
+	pending_size = current_size;
+      } else {
+	MergeStep(current_size, comparer, buffer,
+		  &pending, &pending_size, &pending_left);
+      }
+      current += current_size;
+    }
+  }
+
+  // Merges a pending fragment with the adjacent block until one of
+  // them is exhausted. The rest becomes a new pending fragment.
+  static void MergeStep(size_t current_size, Comparer &comparer,
+			Value *buffer, Iterator *pending, size_t *pending_size,
+			bool *pending_left) {
+    Iterator right = *pending + *pending_size, right_end = right + current_size;
+    std::move(*pending, right, buffer);
+
+    Value *left = buffer, *left_end = buffer + *pending_size;
+    Iterator out = *pending;
+    if (*pending_left) {
+      while (left != left_end && right != right_end) {
+	if (comparer(*right, *left))
+	  *out++ = std::move(*right++);
+	else
+	  *out++ = std::move(*left++);
+      }
+    } else {
+      while (left != left_end && right != right_end) {
+	if (comparer(*left, *right))
+	  *out++ = std::move(*left++);
+	else
+	  *out++ = std::move(*right++);
+      }
+    }
+
+    *pending = out;
+    if (left == left_end) {
+      *pending_size = right_end - right;
+      *pending_left = !*pending_left;
+    } else {
+      *pending_size = left_end - left;
+      std::move(left, left_end, out);
+    }
+  }
+}; // class BlockMerger
+
+// Stable merge sort with O(sqrt(n)) extra memory.
+class BlockMergeSort {
+ public:
+  explicit BlockMergeSort(size_t run_size = kBlockMergeInsertionRun):
+    run_size_(run_size) {
+  }
+
+  template<typename Iterator, typename Comparer>
+  void operator() (Iterator first, Iterator last, Comparer comparer) const {
+    typedef BlockMerger<Iterator, Comparer> Merger;
+    typedef typename Merger::Value Value;
+
+    const size_t size = last - first;
+    const size_t buffer_size = Merger::EstimateBufferSize(size);
+
+    Value *buffer = new (std::nothrow) Value [buffer_size];
+    size_t *labels = new (std::nothrow) size_t [2 * buffer_size];
+    if (buffer == NULL || labels == NULL) {
+      clog << "BlockMergeSort: can't allocate buffer" << endl;
+      clog << "Terminating...";
+      exit(-1);
+    }
+
+    Merger::Sort(size, first, comparer, buffer, labels, buffer_size,
+		 run_size_);
+
+    delete [] labels;
+    delete [] buffer;
+  }
+
+ private:
+  size_t run_size_;
+}; // class BlockMergeSort
+
+// Sorts halves in separate threads and merges them with BlockMerger.
+// Each of num_threads + 1 workers owns a sqrt(n) buffer, so extra memory
+// is O(num_threads * sqrt(n)). Ranges shorter than min_parallel_size
+// are sorted without spawning threads.
+class ParallelBlockMergeSort {
+ public:
+  explicit ParallelBlockMergeSort(size_t num_threads,
+				  size_t min_parallel_size = 0,
+				  size_t run_size = kBlockMergeInsertionRun):
+    num_threads_(num_threads),
+    min_parallel_size_(std::max(min_parallel_size,
+				2 * kBlockMergeInsertionRun)),
+    run_size_(run_size) {
+  }
+
+  template<typename Iterator, typename Comparer>
+  void operator() (Iterator first, Iterator last, Comparer comparer) const {
+    typedef typename BlockMerger<Iterator, Comparer>::Value Value;
+
+    const size_t size = last - first;
+    const size_t num_workers = num_threads_ + 1;
+
+    Workspace<Value> workspace;
+    workspace.buffer_size_ =
+      BlockMerger<Iterator, Comparer>::EstimateBufferSize(size);
+    workspace.buffers_ =
+      new (std::nothrow) Value [num_workers * workspace.buffer_size_];
+    workspace.labels_ =
+      new (std::nothrow) size_t [2 * num_workers * workspace.buffer_size_];
+    if (workspace.buffers_ == NULL || workspace.labels_ == NULL) {
+      clog << "ParallelBlockMergeSort: can't allocate buffer" << endl;
+      clog << "Terminating...";
+      exit(-1);
+    }
+
+    SortImpl(size, first, comparer, num_threads_, 0, &workspace);
+
+    delete [] workspace.labels_;
+    delete [] workspace.buffers_;
+  }
+
+ private:
+  template<typename Value>
+  struct Workspace {
+    size_t buffer_size_;
+    Value *buffers_;
+    size_t *labels_;
+  }; // struct Workspace
+
+  // Sorts objects using workers [worker, worker + thread_limit].
+  template<typename Iterator, typename Comparer, typename Value>
+  void SortImpl(size_t size, Iterator objects, Comparer comparer,
+		size_t thread_limit, size_t worker,
+		const Workspace<Value> *workspace) const {
+    typedef BlockMerger<Iterator, Comparer> Merger;
+
+    Value *buffer = workspace->buffers_ + worker * workspace->buffer_size_;
+    size_t *labels = workspace->labels_ + 2 * worker * workspace->buffer_size_;
+
+    if (thread_limit == 0 || size < min_parallel_size_) {
+      Merger::Sort(size, objects, comparer, buffer, labels,
+		   workspace->buffer_size_, run_size_);
+      return;
+    }
+
+    size_t left_size = size / 2, right_size = size - left_size;
+    size_t left_threads = (thread_limit - 1) / 2;
+    size_t right_threads = thread_limit - 1 - left_threads;
+    boost::thread thread(
+      &ParallelBlockMergeSort::SortImpl<Iterator, Comparer, Value>, this,
+      right_size, objects + left_size, comparer, right_threads,
+      worker + left_threads + 1, workspace);
+    SortImpl(left_size, objects, comparer, left_threads, worker, workspace);
+    thread.join();
+
+    Merger::Merge(left_size, right_size, objects, comparer,
+		  buffer, labels, workspace->buffer_size_);
+  }
+
+
+  size_t num_threads_;
+  size_t min_parallel_size_;
+  size_t run_size_;
+}; // class ParallelBlockMergeSort
+
+template<typename T, typename Comparer>
+class BlockMergeSorter:
+  public SorterAdapter<T, Comparer, BlockMergeSort> {
+ public:
+  BlockMergeSorter(size_t run_size = kBlockMergeInsertionRun):
+    SorterAdapter<T, Comparer, BlockMergeSort>(BlockMergeSort(run_size)) {
+  }
+}; // class BlockMergeSorter
+
+template<typename T, typename Comparer>
+class ParallelBlockMergeSorter:
+  public SorterAdapter<T, Comparer, ParallelBlockMergeSort> {
+ public:
+  ParallelBlockMergeSorter(size_t num_threads,
+			   size_t min_parallel_size = 0,
+			   size_t run_size = kBlockMergeInsertionRun):
+    SorterAdapter<T, Comparer, ParallelBlockMergeSort>(
+      ParallelBlockMergeSort(num_threads, min_parallel_size, run_size)) {
+  }
+}; // class ParallelBlockMergeSorter
+
+}  // namespace sorters
+
+#endif // #ifndef SORTERS_BLOCK_MERGE_SORTERS_H
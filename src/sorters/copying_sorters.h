@@ -0,0 +1,100 @@
+#ifndef SORTERS_COPYING_SORTERS_H
+#define SORTERS_COPYING_SORTERS_H
+
+#include <stdlib.h>
+
+#include <algorithm>
+#include <iostream>
+#include <iterator>
+#include <new>
+
+using std::clog;
+using std::endl;
+
+
+namespace sorters {
+
+// Counterparts of InsertionSort and StlPartitionSort which copy objects
+// instead of moving them, as sorters did before. They make the same
+// comparisons, so --api_benchmark compares them to measure the gain
+// of moves alone.
+class CopyingInsertionSort {
+ public:
+  template<typename Iterator, typename Comparer>
+  void operator() (Iterator first, Iterator last, Comparer comparer) const {
+    typedef typename std::iterator_traits<Iterator>::value_type Value;
+
+    if (first == last)
+      return;
+
+    for (Iterator i = first + 1; i != last; ++i) {
+      Value current(*i);
+      Iterator j = i;
+
+      while (j != first && comparer(current, *(j - 1))) {
+	*j = *(j - 1);
+	--j;
+      }
+      *j = current;
+    }
+  }
+}; // class CopyingInsertionSort
+
+class CopyingPartitionSort {
+ public:
+  template<typename Iterator, typename Comparer>
+  void operator() (Iterator first, Iterator last, Comparer comparer) const {
+    typedef typename std::iterator_traits<Iterator>::value_type Value;
+
+    const size_t size = last - first;
+    Value *buffer = new (std::nothrow) Value [EstimateBufferSize(size)];
+
+    if (buffer == NULL) {
+      clog << "CopyingPartitionSort: can't allocate buffer" << endl;
+      clog << "Terminating...";
+      exit(-1);
+    }
+
+    Value *free_position = buffer;
+    PartitionSort(size, first, comparer, &free_position);
+
+    delete [] buffer;
+  }
+
+ private:
+  static size_t EstimateBufferSize(size_t size) {
+    if (size < 2)
+      return 0;
+    size_t left_size = size / 2, right_size = size - left_size;
+    return size +
+      EstimateBufferSize(left_size) +
+      EstimateBufferSize(right_size);
+  }
+
+  template<typename Iterator, typename Comparer, typename Value>
+  static void PartitionSort(size_t size, Iterator objects,
+			    Comparer &comparer, Value **free_position) {
+    if (size < 2)
+      return;
+    size_t left_size = size / 2, right_size = size - left_size;
+
+    Value *left_buffer = *free_position;
+    *free_position += left_size;
+    Value *right_buffer = *free_position;
+    *free_position += right_size;
+
+    std::copy(objects, objects + left_size, left_buffer);
+    std::copy(objects + left_size, objects + size, right_buffer);
+
+    PartitionSort(left_size, left_buffer, comparer, free_position);
+    PartitionSort(right_size, right_buffer, comparer, free_position);
+
+    std::merge(left_buffer, left_buffer + left_size,
+	       right_buffer, right_buffer + right_size,
+	       objects, comparer);
+  }
+}; // class CopyingPartitionSort
+
+}  // namespace sorters
+
+#endif // #ifndef SORTERS_COPYING_SORTERS_H
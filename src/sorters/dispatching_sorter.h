@@ -0,0 +1,134 @@
+#ifndef SORTERS_DISPATCHING_SORTER_H
+#define SORTERS_DISPATCHING_SORTER_H
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "boost/ptr_container/ptr_vector.hpp"
+
+#include "generators/distributions.h"
+#include "sorters/block_merge_sorters.h"
+#include "sorters/multithreaded_sorters.h"
+#include "sorters/sorter_interface.h"
+#include "sorters/stl_sorters.h"
+#include "sorters/tuning_profile.h"
+
+
+namespace sorters {
+
+const char kStlBasicAlgorithm[] = "stl_basic_sorter";
+const char kStlStableAlgorithm[] = "stl_stable_sorter";
+const char kBlockMergeAlgorithm[] = "block_merge_sorter";
+const char kParallelBlockMergeAlgorithm[] = "parallel_block_merge_sorter";
+const char kMultithreadedQuickAlgorithm[] =
+  "multithreaded_randomized_quick_sorter";
+
+const size_t kClassifierSampleSize = 64;
+// Smaller inputs are taken for random ones, as sorting them costs about
+// as much as sorting the sample.
+const size_t kMinClassifiedSize = 16 * kClassifierSampleSize;
+
+// Creates a sorter described by entry, or returns NULL if algorithm is
+// unknown.
+template<typename T, typename Comparer>
+SorterInterface<T, Comparer>* CreateSorter(const TuningEntry &entry) {
+  if (entry.algorithm_ == kStlBasicAlgorithm)
+    return new StlBasicSorter<T, Comparer>();
+  if (entry.algorithm_ == kStlStableAlgorithm)
+    return new StlStableSorter<T, Comparer>();
+  if (entry.algorithm_ == kBlockMergeAlgorithm)
+    return new BlockMergeSorter<T, Comparer>(entry.leaf_size_);
+  if (entry.algorithm_ == kParallelBlockMergeAlgorithm)
+    return new ParallelBlockMergeSorter<T, Comparer>(entry.num_threads_,
+						     entry.min_parallel_size_,
+						     entry.leaf_size_);
+  if (entry.algorithm_ == kMultithreadedQuickAlgorithm)
+    return new MultithreadedRandomizedQuickSorter<T, Comparer>(
+      entry.num_threads_, entry.min_parallel_size_);
+  return NULL;
+}
+
+// Guesses which of generators::kDistributions objects come from by
+// looking at kClassifierSampleSize evenly spaced objects: a half of
+// duplicates in the sample means few_unique, 90% of ordered neighbours
+// means nearly_sorted or reversed.
+template<typename T, typename Comparer>
+std::string ClassifyInput(size_t size, const T *objects, Comparer &comparer) {
+  const size_t sample_size = std::min(size, kClassifierSampleSize);
+  if (sample_size < 2)
+    return generators::kRandomDistribution;
+
+  std::vector<T> sample(sample_size);
+  for (size_t i = 0; i < sample_size; ++i)
+    sample[i] = objects[i * size / sample_size];
+
+  size_t num_ascending = 0, num_descending = 0;
+  for (size_t i = 0; i + 1 < sample_size; ++i) {
+    if (comparer(sample[i + 1], sample[i]))
+      ++num_descending;
+    else
+      ++num_ascending;
+  }
+
+  std::sort(sample.begin(), sample.end(), comparer);
+  size_t num_duplicates = 0;
+  for (size_t i = 0; i + 1 < sample_size; ++i)
+    if (!comparer(sample[i], sample[i + 1]))
+      ++num_duplicates;
+
+  if (2 * num_duplicates >= sample_size)
+    return generators::kFewUniqueDistribution;
+  if (10 * num_ascending >= 9 * (sample_size - 1))
+    return generators::kNearlySortedDistribution;
+  if (10 * num_descending >= 9 * (sample_size - 1))
+    return generators::kReversedDistribution;
+  return generators::kRandomDistribution;
+}
+
+// Picks an algorithm and its parameters from the tuning profile by
+// element type, size and class of the input. Falls back to std::sort
+// when the profile knows nothing about the input. Sorters for entries
+// of the profile are created once, so a DispatchingSorter must not be
+// shared between threads.
+template<typename T, typename Comparer>
+class DispatchingSorter: public SorterInterface<T, Comparer> {
+ public:
+  DispatchingSorter(const TuningProfile &profile, const std::string &type):
+    profile_(profile), type_(type) {
+    const std::vector<TuningEntry> &entries = profile_.entries();
+    for (size_t i = 0; i < entries.size(); ++i)
+      sorters_.push_back(entries[i].type_ == type_ ?
+			 CreateSorter<T, Comparer>(entries[i]) : NULL);
+  }
+
+  virtual void Sort(size_t size, T *objects) {
+    Comparer comparer;
+
+    const std::string input_class = size < kMinClassifiedSize ?
+      generators::kRandomDistribution :
+      ClassifyInput(size, objects, comparer);
+    const TuningEntry *entry = profile_.Find(type_, input_class, size);
+
+    if (entry != NULL) {
+      const size_t index = entry - &profile_.entries().front();
+      if (!sorters_.is_null(index)) {
+	sorters_[index].Sort(size, objects);
+	return;
+      }
+    }
+    fallback_sorter_.Sort(size, objects);
+  }
+
+ private:
+  const TuningProfile profile_;
+  const std::string type_;
+  // sorters_[i] sorts inputs matched by profile_.entries()[i], or is NULL
+  // if the entry is for another type or has an unknown algorithm.
+  boost::ptr_vector<boost::nullable<SorterInterface<T, Comparer> > > sorters_;
+  StlBasicSorter<T, Comparer> fallback_sorter_;
+}; // class DispatchingSorter
+
+}  // namespace sorters
+
+#endif // #ifndef SORTERS_DISPATCHING_SORTER_H
@@ -0,0 +1,238 @@
+#ifndef SORTERS_HEAP_SORTERS_H
+#define SORTERS_HEAP_SORTERS_H
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <iterator>
+#include <utility>
+
+#include "boost/thread/thread.hpp"
+
+#include "base/macros.h"
+#include "sorters/sorter_interface.h"
+
+
+namespace sorters {
+
+const size_t kCacheLineSize = 64;
+
+const size_t kDaryHeapMinParallelSize = 1 << 16;
+
+// Heapsort on an Arity-ary max-heap, which is log2(Arity) times
+// shallower than the binary heap of std::make_heap. When Arity objects
+// fit into a cache line, the heap starts up to Arity - 1 objects after
+// the front of the range, so that children of every node share a cache
+// line; skipped objects are inserted into the sorted heap at the end.
+//
+// Maximum is extracted by bottom-up sift-down: the hole goes down to a
+// leaf along larger children without comparing them to the last object,
+// which is then sifted up from the leaf, where it usually belongs.
+// Grandchildren are prefetched while children are compared. Heaps of at
+// least min_parallel_size objects are built by num_threads + 1 threads,
+// each building a part of subheaps. Extra memory is O(1).
+template<size_t Arity>
+class DaryHeapSort {
+ public:
+  explicit DaryHeapSort(size_t num_threads = 0,
+			size_t min_parallel_size = kDaryHeapMinParallelSize):
+    num_threads_(num_threads), min_parallel_size_(min_parallel_size) {
+  }
+
+  template<typename Iterator, typename Comparer>
+  void operator() (Iterator first, Iterator last, Comparer comparer) const {
+    typedef typename std::iterator_traits<Iterator>::value_type Value;
+
+    const size_t size = last - first;
+    if (size < 2)
+      return;
+
+    const size_t skip = std::min(size, AlignmentSkip(first));
+    Iterator heap = first + skip;
+    const size_t heap_size = size - skip;
+
+    BuildHeap(heap_size, heap, comparer);
+    for (size_t current_size = heap_size; current_size > 1; --current_size)
+      PopHeap(current_size, heap, comparer);
+
+    for (size_t i = skip; i > 0; --i) {
+      Iterator position = std::upper_bound(first + i, last, first[i - 1],
+					   comparer);
+      Value value(std::move(first[i - 1]));
+      std::move(first + i, position, first + i - 1);
+      *(position - 1) = std::move(value);
+    }
+  }
+
+ private:
+  // Returns number of objects to leave before the heap, so that the
+  // first child of every node lies at a multiple of Arity objects.
+  template<typename Iterator>
+  static size_t AlignmentSkip(Iterator first) {
+    typedef typename std::iterator_traits<Iterator>::value_type Value;
+
+    const size_t group_size = Arity * sizeof(Value);
+    if (kCacheLineSize % group_size != 0)
+      return 0;
+
+    // Children of the root start right after it.
+    const uintptr_t children =
+      reinterpret_cast<uintptr_t>(&*first) + sizeof(Value);
+    return (group_size - children % group_size) % group_size / sizeof(Value);
+  }
+
+  // Returns the largest child of node, or size if node is a leaf.
+  template<typename Iterator, typename Comparer>
+  static size_t MaxChild(size_t size, Iterator heap, size_t node,
+			 Comparer &comparer) {
+    typedef typename std::iterator_traits<Iterator>::value_type Value;
+
+    const size_t first_child = Arity * node + 1;
+    if (first_child >= size)
+      return size;
+    const size_t last_child = std::min(first_child + Arity, size);
+
+    // Children of consecutive children are adjacent, so a cache line
+    // is prefetched once.
+    const size_t groups_per_line =
+      std::max<size_t>(1, kCacheLineSize / (Arity * sizeof(Value)));
+    for (size_t child = first_child; child < last_child;
+	 child += groups_per_line) {
+      const size_t grandchild = Arity * child + 1;
+      if (grandchild >= size)
+	break;
+      PREFETCH(&heap[grandchild]);
+    }
+
+    size_t result = first_child;
+    for (size_t child = first_child + 1; child < last_child; ++child)
+      if (comparer(heap[result], heap[child]))
+	result = child;
+    return result;
+  }
+
+  template<typename Iterator, typename Comparer>
+  static void SiftDown(size_t size, Iterator heap, size_t node,
+		       Comparer &comparer) {
+    typedef typename std::iterator_traits<Iterator>::value_type Value;
+
+    Value value(std::move(heap[node]));
+    while (true) {
+      const size_t child = MaxChild(size, heap, node, comparer);
+      if (child == size || !comparer(value, heap[child]))
+	break;
+      heap[node] = std::move(heap[child]);
+      node = child;
+    }
+    heap[node] = std::move(value);
+  }
+
+  // Moves maximum to heap[size - 1] and restores the heap on the rest.
+  template<typename Iterator, typename Comparer>
+  static void PopHeap(size_t size, Iterator heap, Comparer &comparer) {
+    typedef typename std::iterator_traits<Iterator>::value_type Value;
+
+    const size_t new_size = size - 1;
+    Value value(std::move(heap[new_size]));
+    heap[new_size] = std::move(heap[0]);
+
+    size_t hole = 0;
+    while (true) {
+      const size_t child = MaxChild(new_size, heap, hole, comparer);
+      if (child == new_size)
+	break;
+      heap[hole] = std::move(heap[child]);
+      hole = child;
+    }
+
+    while (hole > 0) {
+      const size_t parent = (hole - 1) / Arity;
+      if (!comparer(heap[parent], value))
+	break;
+      heap[hole] = std::move(heap[parent]);
+      hole = parent;
+    }
+    heap[hole] = std::move(value);
+  }
+
+  // Builds subheaps rooted at nodes [begin, end) of a single level.
+  // Their descendants occupy a contiguous range of each lower level, so
+  // subheaps of disjoint ranges may be built concurrently.
+  template<typename Iterator, typename Comparer>
+  static void BuildSubheaps(size_t size, Iterator heap, size_t begin,
+			    size_t end, Comparer comparer) {
+    if (size < 2)
+      return;
+    const size_t num_internal = (size - 2) / Arity + 1;
+
+    // Descends to the lowest level with internal nodes, then sifts down
+    // level by level going up, as parents of [begin, end) are
+    // [(begin - 1) / Arity, (end - 1) / Arity).
+    const size_t top_begin = begin;
+    if (begin >= num_internal)
+      return;
+    while (Arity * begin + 1 < num_internal) {
+      begin = Arity * begin + 1;
+      end = Arity * end + 1;
+    }
+
+    while (true) {
+      for (size_t node = std::min(end, num_internal); node > begin; --node)
+	SiftDown(size, heap, node - 1, comparer);
+      if (begin == top_begin)
+	break;
+      begin = (begin - 1) / Arity;
+      end = (end - 1) / Arity;
+    }
+  }
+
+  template<typename Iterator, typename Comparer>
+  void BuildHeap(size_t size, Iterator heap, Comparer &comparer) const {
+    const size_t num_workers = num_threads_ + 1;
+
+    // Finds the first level with a node for every worker.
+    size_t level_begin = 0, level_end = 1;
+    while (level_end - level_begin < num_workers && level_end < size) {
+      level_begin = level_end;
+      level_end = Arity * level_end + 1;
+    }
+
+    if (num_threads_ == 0 || size < min_parallel_size_ || level_end > size) {
+      BuildSubheaps(size, heap, 0, 1, comparer);
+      return;
+    }
+
+    const size_t level_size = level_end - level_begin;
+    boost::thread_group threads;
+    for (size_t worker = 0; worker < num_threads_; ++worker)
+      threads.add_thread(new boost::thread(
+	&DaryHeapSort::BuildSubheaps<Iterator, Comparer>, size, heap,
+	level_begin + worker * level_size / num_workers,
+	level_begin + (worker + 1) * level_size / num_workers, comparer));
+    BuildSubheaps(size, heap,
+		  level_begin + num_threads_ * level_size / num_workers,
+		  level_end, comparer);
+    threads.join_all();
+
+    for (size_t node = level_begin; node > 0; --node)
+      SiftDown(size, heap, node - 1, comparer);
+  }
+
+
+  size_t num_threads_;
+  size_t min_parallel_size_;
+}; // class DaryHeapSort
+
+template<typename T, typename Comparer, size_t Arity>
+class DaryHeapSorter: public SorterAdapter<T, Comparer, DaryHeapSort<Arity> > {
+ public:
+  explicit DaryHeapSorter(size_t num_threads = 0,
+			  size_t min_parallel_size = kDaryHeapMinParallelSize):
+    SorterAdapter<T, Comparer, DaryHeapSort<Arity> >(
+      DaryHeapSort<Arity>(num_threads, min_parallel_size)) {
+  }
+}; // class DaryHeapSorter
+
+}  // namespace sorters
+
+#endif // #ifndef SORTERS_HEAP_SORTERS_H
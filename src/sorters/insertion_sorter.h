@@ -1,36 +1,41 @@
 #ifndef SORTERS_INSERTION_SORTER_H
 #define SORTERS_INSERTION_SORTER_H
 
-#include <functional>
+#include <iterator>
+#include <utility>
 
-#include "base/macros.h"
 #include "sorters/sorter_interface.h"
 
 
 namespace sorters {
 
+// Stable insertion sort which moves objects instead of copying them.
+class InsertionSort {
+ public:
+  template<typename Iterator, typename Comparer>
+  void operator() (Iterator first, Iterator last, Comparer comparer) const {
+    typedef typename std::iterator_traits<Iterator>::value_type Value;
+
+    if (first == last)
+      return;
+
+    for (Iterator i = first + 1; i != last; ++i) {
+      Value current(std::move(*i));
+      Iterator j = i;
+
+      while (j != first && comparer(current, *(j - 1))) {
+	*j = std::move(*(j - 1));
+	--j;
+      }
+      *j = std::move(current);
+    }
+  }
+}; // class InsertionSort
+
 template<typename T, typename Comparer>
-class InsertionSorter: public SorterInterface<T, Comparer> {
+class InsertionSorter: public SorterAdapter<T, Comparer, InsertionSort> {
  public:
    InsertionSorter() {}
-
-   virtual void Sort(size_t size, T *objects) {
-     Comparer comparer;
-
-     size_t i = 1, j;
-     while (i < size) {
-       T current(objects[i]);
-       j = i;
-
-       while (j > 0 && !comparer(objects[j - 1], current)) {
-	 objects[j] = objects[j - 1];
-	 --j;
-       }
-       objects[j] = current;
-
-       ++i;
-     }
-   }
 }; // class InsertionSorter
 
 }  // namespace sorters
@@ -1,61 +1,76 @@
 #ifndef MULTITHREADED_SORTERS_H
 #define MULTITHREADED_SORTERS_H
 
-#include <cstdio>
+#include <stdlib.h>
 
+#include <algorithm>
 #include <functional>
+#include <utility>
 
 #include <boost/thread/thread.hpp>
 
+#include "sorters/sorter_interface.h"
+
 
 namespace sorters {
 
-template<typename T, typename Comparer>
-class MultithreadedRandomizedQuickSorter: public SorterInterface<T, Comparer> {
+// Ranges shorter than min_parallel_size are sorted without spawning
+// threads.
+class MultithreadedRandomizedQuickSort {
  public:
-   MultithreadedRandomizedQuickSorter(size_t num_threads):
-     num_threads_(num_threads) {
+   explicit MultithreadedRandomizedQuickSort(size_t num_threads,
+					     size_t min_parallel_size = 0):
+     num_threads_(num_threads), min_parallel_size_(min_parallel_size) {
    }
 
-   virtual void Sort(size_t size, T *objects) {
-     Comparer comparer;
-
-     SortImpl(size, objects, comparer, num_threads_);
+   template<typename Iterator, typename Comparer>
+   void operator() (Iterator first, Iterator last, Comparer comparer) const {
+     SortImpl(last - first, first, comparer, num_threads_, min_parallel_size_);
    }
 
  private:
-   static void Partition(size_t size, T *objects, Comparer &comparer,
-		  size_t *left_bound, size_t *right_bound) {
-     std::swap(objects[rand() % size], objects[size - 1]);
-     T pivot = objects[size - 1];
-
-     *left_bound = 0;
-     for (size_t i = 0; i < size; ++i)
-       if (comparer(objects[i], pivot)) {
+   // Splits objects into [0, left_bound) less than pivot,
+   // [left_bound, right_bound) equal to pivot and the rest. Pivot is
+   // kept at the front while partitioning, so it's never copied.
+   template<typename Iterator, typename Comparer>
+   static void Partition(size_t size, Iterator objects, Comparer &comparer,
+			 size_t *left_bound, size_t *right_bound) {
+     std::swap(objects[rand() % size], objects[0]);
+
+     *left_bound = 1;
+     for (size_t i = 1; i < size; ++i)
+       if (comparer(objects[i], objects[0])) {
 	 std::swap(objects[*left_bound], objects[i]);
 	 ++*left_bound;
        }
 
-     *right_bound = *left_bound;
-     for (size_t i = *left_bound; i < size; ++i)
-       if (!comparer(pivot, objects[i])) {
+     --*left_bound;
+     std::swap(objects[0], objects[*left_bound]);
+
+     const size_t pivot = *left_bound;
+     *right_bound = *left_bound + 1;
+     for (size_t i = *right_bound; i < size; ++i)
+       if (!comparer(objects[pivot], objects[i])) {
 	 std::swap(objects[*right_bound], objects[i]);
 	 ++*right_bound;
        }
    }
 
-   static void SortImpl(size_t size, T *objects, Comparer &comparer,
-			size_t thread_limit) {
+   template<typename Iterator, typename Comparer>
+   static void SortImpl(size_t size, Iterator objects, Comparer comparer,
+			size_t thread_limit, size_t min_parallel_size) {
      if (size > 1) {
-       if (thread_limit > 0) {
+       if (thread_limit > 0 && size >= min_parallel_size) {
 	 size_t left_bound, right_bound;
 	 Partition(size, objects, comparer, &left_bound, &right_bound);
 
 	 size_t left_threads = (thread_limit - 1) / 2;
 	 size_t right_threads = thread_limit - 1 - left_threads;
-	 boost::thread thread(&SortImpl, size - right_bound,
-			      objects + right_bound, comparer, right_threads);
-	 SortImpl(left_bound, objects, comparer, left_threads);
+	 boost::thread thread(&SortImpl<Iterator, Comparer>,
+			      size - right_bound, objects + right_bound,
+			      comparer, right_threads, min_parallel_size);
+	 SortImpl(left_bound, objects, comparer, left_threads,
+		  min_parallel_size);
 	 thread.join();
        } else
 	 std::sort(objects, objects + size, comparer);
@@ -64,6 +79,18 @@ class MultithreadedRandomizedQuickSorter: public SorterInterface<T, Comparer> {
 
 
    size_t num_threads_;
+   size_t min_parallel_size_;
+}; // class MultithreadedRandomizedQuickSort
+
+template<typename T, typename Comparer>
+class MultithreadedRandomizedQuickSorter:
+    public SorterAdapter<T, Comparer, MultithreadedRandomizedQuickSort> {
+ public:
+   MultithreadedRandomizedQuickSorter(size_t num_threads,
+				      size_t min_parallel_size = 0):
+     SorterAdapter<T, Comparer, MultithreadedRandomizedQuickSort>(
+       MultithreadedRandomizedQuickSort(num_threads, min_parallel_size)) {
+   }
 }; // class MultithreadedRandomizedQuickSorter
 
 }  // namespace sorters
@@ -0,0 +1,166 @@
+#ifndef SORTERS_SORT_SERVICE_H
+#define SORTERS_SORT_SERVICE_H
+
+#include <deque>
+
+#include "boost/bind/bind.hpp"
+#include "boost/ptr_container/ptr_vector.hpp"
+#include "boost/shared_ptr.hpp"
+#include "boost/thread/condition_variable.hpp"
+#include "boost/thread/future.hpp"
+#include "boost/thread/mutex.hpp"
+#include "boost/thread/thread.hpp"
+#include "boost/utility.hpp"
+
+#include "base/timer.h"
+#include "sorters/sorter_interface.h"
+
+
+namespace sorters {
+
+enum SortStatus {
+  kSorted,
+  kRejected
+}; // enum SortStatus
+
+struct SortResult {
+  SortStatus status_;
+  // Time between submission and start of sorting.
+  double queue_time_;
+  double sorting_time_;
+}; // struct SortResult
+
+struct SortServiceOptions {
+  size_t num_workers_;
+  // Jobs submitted when this many jobs wait in queues are rejected.
+  size_t max_pending_jobs_;
+  // Jobs not larger than this are served before larger ones, but no
+  // more than max_small_streak in a row while large jobs wait.
+  size_t small_job_size_;
+  size_t max_small_streak_;
+}; // struct SortServiceOptions
+
+// Runs sorting jobs submitted from many threads on a single bounded
+// pool of workers, so concurrent requests don't oversubscribe cores.
+// Each worker owns a sorter created by a factory, so sorters don't
+// have to be thread-safe, but they shouldn't spawn threads themselves.
+template<typename T, typename Comparer>
+class SortService: boost::noncopyable {
+ public:
+  typedef SorterInterface<T, Comparer>* (*SorterFactory) ();
+
+  SortService(const SortServiceOptions &options, SorterFactory factory):
+    options_(options), small_streak_(0), stopping_(false) {
+    for (size_t i = 0; i < options_.num_workers_; ++i)
+      sorters_.push_back(factory());
+    for (size_t i = 0; i < options_.num_workers_; ++i)
+      workers_.create_thread(boost::bind(&SortService::WorkerLoop, this, i));
+  }
+
+  // Finishes all accepted jobs.
+  ~SortService() {
+    {
+      boost::mutex::scoped_lock lock(mutex_);
+      stopping_ = true;
+    }
+    has_jobs_.notify_all();
+    workers_.join_all();
+  }
+
+  // Schedules sorting of objects, which must stay valid until the
+  // returned future is ready. If too many jobs are pending, the future
+  // is immediately ready with kRejected status.
+  boost::shared_future<SortResult> Submit(size_t size, T *objects) {
+    Job job;
+    job.size_ = size;
+    job.objects_ = objects;
+    job.promise_.reset(new boost::promise<SortResult>());
+    boost::shared_future<SortResult> future(job.promise_->get_future());
+
+    {
+      boost::mutex::scoped_lock lock(mutex_);
+      if (small_jobs_.size() + large_jobs_.size() <
+	  options_.max_pending_jobs_) {
+	if (size <= options_.small_job_size_)
+	  small_jobs_.push_back(job);
+	else
+	  large_jobs_.push_back(job);
+	has_jobs_.notify_one();
+	return future;
+      }
+    }
+
+    SortResult result;
+    result.status_ = kRejected;
+    result.queue_time_ = 0.0;
+    result.sorting_time_ = 0.0;
+    job.promise_->set_value(result);
+    return future;
+  }
+
+ private:
+  struct Job {
+    size_t size_;
+    T *objects_;
+    base::Timer timer_;
+    boost::shared_ptr<boost::promise<SortResult> > promise_;
+  }; // struct Job
+
+  // Returns false when service is stopping and queues are empty.
+  bool PopJob(Job *job) {
+    boost::mutex::scoped_lock lock(mutex_);
+    while (!stopping_ && small_jobs_.empty() && large_jobs_.empty())
+      has_jobs_.wait(lock);
+
+    bool take_small = !small_jobs_.empty();
+    if (take_small && !large_jobs_.empty() &&
+	small_streak_ >= options_.max_small_streak_)
+      take_small = false;
+
+    if (take_small) {
+      *job = small_jobs_.front();
+      small_jobs_.pop_front();
+      ++small_streak_;
+    } else if (!large_jobs_.empty()) {
+      *job = large_jobs_.front();
+      large_jobs_.pop_front();
+      small_streak_ = 0;
+    } else {
+      return false;
+    }
+    return true;
+  }
+
+  void WorkerLoop(size_t worker) {
+    Job job;
+    while (PopJob(&job)) {
+      SortResult result;
+      result.status_ = kSorted;
+      result.queue_time_ = job.timer_.Elapsed();
+
+      base::Timer timer;
+      sorters_[worker].Sort(job.size_, job.objects_);
+      result.sorting_time_ = timer.Elapsed();
+
+      job.promise_->set_value(result);
+      job.promise_.reset();
+    }
+  }
+
+
+  const SortServiceOptions options_;
+
+  boost::ptr_vector<SorterInterface<T, Comparer> > sorters_;
+  boost::thread_group workers_;
+
+  boost::mutex mutex_;
+  boost::condition_variable has_jobs_;
+  std::deque<Job> small_jobs_;
+  std::deque<Job> large_jobs_;
+  size_t small_streak_;
+  bool stopping_;
+}; // class SortService
+
+}  // namespace sorters
+
+#endif // #ifndef SORTERS_SORT_SERVICE_H
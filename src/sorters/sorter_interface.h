@@ -16,6 +16,32 @@ class SorterInterface: boost::noncopyable {
     virtual void Sort(size_t size, T *objects) = 0;
 }; // class SorterInterface
 
+// Exposes a statically dispatched sort algorithm through SorterInterface.
+// Algorithm is a copyable class with a method
+//
+// template<typename Iterator, typename Comparer>
+// void operator() (Iterator first, Iterator last, Comparer comparer) const;
+//
+// which sorts random-access range [first, last) moving objects around.
+// Such algorithms may be called directly when types are known at compile
+// time, so comparisons are inlined and comparers may carry state.
+template<typename T, typename Comparer, typename Algorithm>
+class SorterAdapter: public SorterInterface<T, Comparer> {
+  public:
+    explicit SorterAdapter(const Algorithm &algorithm = Algorithm()):
+      algorithm_(algorithm) {
+    }
+
+    virtual void Sort(size_t size, T *objects) {
+      algorithm_(objects, objects + size, Comparer());
+    }
+
+    const Algorithm& algorithm() const { return algorithm_; }
+
+  private:
+    Algorithm algorithm_;
+}; // class SorterAdapter
+
 }  // namespace sorters
 
 #endif // #ifndef SORTERS_SORTER_INTERFACE_H
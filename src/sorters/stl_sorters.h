@@ -6,6 +6,9 @@
 #include <algorithm>
 #include <functional>
 #include <iostream>
+#include <iterator>
+#include <new>
+#include <utility>
 
 #include "sorters/sorter_interface.h"
 
@@ -15,62 +18,56 @@ using std::endl;
 
 namespace sorters {
 
-template<typename T, typename Comparer>
-class StlBasicSorter: public SorterInterface<T, Comparer> {
+class StlSort {
   public:
-    StlBasicSorter() {}
-
-    virtual void Sort(size_t size, T *objects) {
-      std::sort(objects, objects + size, Comparer());
+    template<typename Iterator, typename Comparer>
+    void operator() (Iterator first, Iterator last, Comparer comparer) const {
+      std::sort(first, last, comparer);
     }
-}; // class StlBasicSorter
+}; // class StlSort
 
-template<typename T, typename Comparer>
-class StlStableSorter: public SorterInterface<T, Comparer> {
+class StlStableSort {
   public:
-    StlStableSorter() {}
-
-    virtual void Sort(size_t size, T *objects) {
-      std::stable_sort(objects, objects + size, Comparer());
+    template<typename Iterator, typename Comparer>
+    void operator() (Iterator first, Iterator last, Comparer comparer) const {
+      std::stable_sort(first, last, comparer);
     }
-}; // class StlStableSorter
+}; // class StlStableSort
 
-template<typename T, typename Comparer>
-class StlHeapSorter: public SorterInterface<T, Comparer> {
+class StlHeapSort {
   public:
-    StlHeapSorter() {}
-
-    virtual void Sort(size_t size, T *objects) {
-      Comparer comparer;
-      std::make_heap(objects, objects + size, comparer);
-      std::sort_heap(objects, objects + size, comparer);
+    template<typename Iterator, typename Comparer>
+    void operator() (Iterator first, Iterator last, Comparer comparer) const {
+      std::make_heap(first, last, comparer);
+      std::sort_heap(first, last, comparer);
     }
-}; // class StlHeapSorter
+}; // class StlHeapSort
 
-template<typename T, typename Comparer>
-class StlPartitionSorter: public SorterInterface<T, Comparer> {
+// Merge sort which moves both halves into a fresh part of a buffer
+// before sorting them, so it needs O(n log n) extra memory.
+class StlPartitionSort {
   public:
-    StlPartitionSorter() {}
+    template<typename Iterator, typename Comparer>
+    void operator() (Iterator first, Iterator last, Comparer comparer) const {
+      typedef typename std::iterator_traits<Iterator>::value_type Value;
 
-    virtual void Sort(size_t size, T *objects) {
-      buffer_ = new (std::nothrow) T [EstimateBufferSize(size)];
+      const size_t size = last - first;
+      Value *buffer = new (std::nothrow) Value [EstimateBufferSize(size)];
 
-      if (buffer_ == NULL) {
-	clog << "StlPartitionSorter::Sort: can't allocate buffer" << endl;
+      if (buffer == NULL) {
+	clog << "StlPartitionSort: can't allocate buffer" << endl;
 	clog << "Terminating...";
 	exit(-1);
       }
 
-      free_position_ = 0;
-
-      Comparer comparer;
-      PartitionSort(size, objects, comparer);
+      Value *free_position = buffer;
+      PartitionSort(size, first, comparer, &free_position);
 
-      delete [] buffer_;
+      delete [] buffer;
     }
 
   private:
-    size_t EstimateBufferSize(size_t size) const {
+    static size_t EstimateBufferSize(size_t size) {
       if (size < 2)
 	return 0;
       size_t left_size = size / 2, right_size = size - left_size;
@@ -79,54 +76,56 @@ class StlPartitionSorter: public SorterInterface<T, Comparer> {
 	EstimateBufferSize(right_size);
     }
 
-    void PartitionSort(size_t size, T *objects, Comparer &comparer) {
+    template<typename Iterator, typename Comparer, typename Value>
+    static void PartitionSort(size_t size, Iterator objects,
+			      Comparer &comparer, Value **free_position) {
       if (size < 2)
 	return;
       size_t left_size = size / 2, right_size = size - left_size;
 
-      T *left_buffer = buffer_ + free_position_;
-      free_position_ += left_size;
-      T *right_buffer = buffer_ + free_position_;
-      free_position_ += right_size;
+      Value *left_buffer = *free_position;
+      *free_position += left_size;
+      Value *right_buffer = *free_position;
+      *free_position += right_size;
 
-      std::copy(objects, objects + left_size, left_buffer);
-      std::copy(objects + left_size, objects + size, right_buffer);
+      std::move(objects, objects + left_size, left_buffer);
+      std::move(objects + left_size, objects + size, right_buffer);
 
-      PartitionSort(left_size, left_buffer, comparer);
-      PartitionSort(right_size, right_buffer, comparer);
+      PartitionSort(left_size, left_buffer, comparer, free_position);
+      PartitionSort(right_size, right_buffer, comparer, free_position);
 
-      std::merge(left_buffer, left_buffer + left_size,
-		 right_buffer, right_buffer + right_size,
+      std::merge(std::make_move_iterator(left_buffer),
+		 std::make_move_iterator(left_buffer + left_size),
+		 std::make_move_iterator(right_buffer),
+		 std::make_move_iterator(right_buffer + right_size),
 		 objects, comparer);
     }
-
-    T *buffer_;
-    size_t free_position_;
-}; // class StlPartitionSorter
+}; // class StlPartitionSort
 
 template<typename T, typename Comparer>
-  class StlInplacePartitionSorter: public SorterInterface<T, Comparer> {
+class StlBasicSorter: public SorterAdapter<T, Comparer, StlSort> {
   public:
-    StlInplacePartitionSorter() {}
-
-    virtual void Sort(size_t size, T *objects) {
-      Comparer comparer;
-      PartitionSort(size, objects, comparer);
-    }
+    StlBasicSorter() {}
+}; // class StlBasicSorter
 
-  private:
-    void PartitionSort(size_t size, T *objects, Comparer &comparer) {
-      if (size < 2)
-	return;
+template<typename T, typename Comparer>
+class StlStableSorter: public SorterAdapter<T, Comparer, StlStableSort> {
+  public:
+    StlStableSorter() {}
+}; // class StlStableSorter
 
-      size_t left_size = size / 2, right_size = size - left_size;
-      PartitionSort(left_size, objects, comparer);
-      PartitionSort(right_size, objects + left_size, comparer);
+template<typename T, typename Comparer>
+class StlHeapSorter: public SorterAdapter<T, Comparer, StlHeapSort> {
+  public:
+    StlHeapSorter() {}
+}; // class StlHeapSorter
 
-      std::inplace_merge(objects, objects + left_size, objects + size,
-			 comparer);
-    }
-}; // class StlInplacePartitionSorter
+template<typename T, typename Comparer>
+class StlPartitionSorter:
+    public SorterAdapter<T, Comparer, StlPartitionSort> {
+  public:
+    StlPartitionSorter() {}
+}; // class StlPartitionSorter
 
 }  // namespace sorters
 
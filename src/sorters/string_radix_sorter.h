@@ -0,0 +1,200 @@
+#ifndef SORTERS_STRING_RADIX_SORTER_H
+#define SORTERS_STRING_RADIX_SORTER_H
+
+#include <string.h>
+
+#include <algorithm>
+#include <iterator>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "sorters/sorter_interface.h"
+
+
+namespace sorters {
+
+// Character codes used by radix sort: 0 is an end of a key, bytes are
+// mapped to [1 .. 256].
+const size_t kStringRadixAlphabetSize = 257;
+
+// Ranges shorter than this are sorted by insertion sort.
+const size_t kStringRadixInsertionThreshold = 32;
+
+template<typename T>
+class StringKeyTraits;
+
+template<>
+class StringKeyTraits<std::string> {
+ public:
+  static size_t Code(const std::string &key, size_t depth) {
+    return depth < key.size() ?
+      static_cast<unsigned char>(key[depth]) + 1 : 0;
+  }
+
+  // Compares keys which are known to share first depth characters.
+  static bool Less(const std::string &lhs, const std::string &rhs,
+		   size_t depth) {
+    return lhs.compare(depth, std::string::npos,
+		       rhs, depth, std::string::npos) < 0;
+  }
+}; // class StringKeyTraits
+
+template<>
+class StringKeyTraits<const char*> {
+ public:
+  static size_t Code(const char *key, size_t depth) {
+    return key[depth] == '\0' ?
+      0 : static_cast<unsigned char>(key[depth]) + 1;
+  }
+
+  static bool Less(const char *lhs, const char *rhs, size_t depth) {
+    return strcmp(lhs + depth, rhs + depth) < 0;
+  }
+}; // class StringKeyTraits
+
+// MSD radix sort (American flag sort) for byte strings. Character codes
+// of the current position are cached in a separate array, so each key
+// is touched once per pass, and ranges sharing the next character skip
+// it without permuting, so long common prefixes are scanned once
+// instead of being memcmp'ed on every comparison. Short ranges are
+// finished by insertion sort which compares keys starting from the
+// known common prefix. Comparer must order keys bytewise, as
+// std::less<std::string> and strcmp do.
+class MsdRadixStringSort {
+ public:
+  template<typename Iterator, typename Comparer>
+  void operator() (Iterator first, Iterator last, Comparer comparer) const {
+    const size_t size = last - first;
+    std::vector<unsigned short> codes(size);
+    std::vector<Range> ranges;
+    ranges.push_back(Range(0, size, 0));
+
+    size_t counts[kStringRadixAlphabetSize];
+    while (!ranges.empty()) {
+      Range range = ranges.back();
+      ranges.pop_back();
+
+      if (range.size_ < kStringRadixInsertionThreshold) {
+	InsertionSort(range.size_, first + range.begin_, range.depth_);
+	continue;
+      }
+
+      if (!Distribute(first, &codes[0], &range, counts))
+	continue;
+
+      for (size_t code = 1, begin = range.begin_ + counts[0];
+	   code < kStringRadixAlphabetSize; ++code) {
+	if (counts[code] > 1)
+	  ranges.push_back(Range(begin, counts[code], range.depth_ + 1));
+	begin += counts[code];
+      }
+    }
+  }
+
+ private:
+  struct Range {
+    Range(size_t begin, size_t size, size_t depth):
+      begin_(begin), size_(size), depth_(depth) {
+    }
+
+    size_t begin_;
+    size_t size_;
+    size_t depth_;
+  }; // struct Range
+
+  // Permutes range into buckets by character at range depth. When all
+  // keys have the same character, skips their whole common prefix.
+  // Returns false if all keys in range are equal.
+  template<typename Iterator>
+  static bool Distribute(Iterator objects, unsigned short *codes,
+			 Range *range, size_t *counts) {
+    typedef typename std::iterator_traits<Iterator>::value_type Value;
+
+    Iterator begin = objects + range->begin_;
+    unsigned short *cached = codes + range->begin_;
+
+    while (true) {
+      std::fill(counts, counts + kStringRadixAlphabetSize, 0);
+      for (size_t i = 0; i < range->size_; ++i) {
+	cached[i] = StringKeyTraits<Value>::Code(begin[i], range->depth_);
+	++counts[cached[i]];
+      }
+
+      if (counts[cached[0]] != range->size_)
+	break;
+      if (cached[0] == 0)
+	return false;
+      range->depth_ = CommonPrefixLength(range->size_, begin,
+					 range->depth_ + 1);
+    }
+
+    size_t next[kStringRadixAlphabetSize], end[kStringRadixAlphabetSize];
+    for (size_t code = 0, offset = 0; code < kStringRadixAlphabetSize;
+	 ++code) {
+      next[code] = offset;
+      offset += counts[code];
+      end[code] = offset;
+    }
+
+    for (size_t code = 0; code < kStringRadixAlphabetSize; ++code) {
+      while (next[code] < end[code]) {
+	const size_t i = next[code];
+	const unsigned short current = cached[i];
+	if (current == code) {
+	  ++next[code];
+	} else {
+	  std::swap(begin[i], begin[next[current]]);
+	  std::swap(cached[i], cached[next[current]]);
+	  ++next[current];
+	}
+      }
+    }
+    return true;
+  }
+
+  // Returns length of common prefix of keys which are known to share
+  // first depth characters.
+  template<typename Iterator>
+  static size_t CommonPrefixLength(size_t size, Iterator objects,
+				   size_t depth) {
+    typedef typename std::iterator_traits<Iterator>::value_type Value;
+
+    size_t limit = static_cast<size_t>(-1);
+    for (size_t i = 1; i < size; ++i) {
+      size_t length = depth;
+      while (length < limit) {
+	const size_t code = StringKeyTraits<Value>::Code(objects[0], length);
+	if (code == 0 ||
+	    code != StringKeyTraits<Value>::Code(objects[i], length))
+	  break;
+	++length;
+      }
+      limit = length;
+    }
+    return limit;
+  }
+
+  template<typename Iterator>
+  static void InsertionSort(size_t size, Iterator objects, size_t depth) {
+    typedef typename std::iterator_traits<Iterator>::value_type Value;
+
+    for (size_t i = 1; i < size; ++i)
+      for (size_t j = i;
+	   j > 0 && StringKeyTraits<Value>::Less(objects[j], objects[j - 1],
+						 depth);
+	   --j)
+	std::swap(objects[j], objects[j - 1]);
+  }
+}; // class MsdRadixStringSort
+
+template<typename T, typename Comparer>
+class MsdRadixStringSorter:
+  public SorterAdapter<T, Comparer, MsdRadixStringSort> {
+ public:
+  MsdRadixStringSorter() {}
+}; // class MsdRadixStringSorter
+
+}  // namespace sorters
+
+#endif // #ifndef SORTERS_STRING_RADIX_SORTER_H
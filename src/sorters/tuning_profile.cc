@@ -0,0 +1,117 @@
+#include "sorters/tuning_profile.h"
+
+#include <math.h>
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+#include <boost/thread/thread.hpp>
+
+
+namespace sorters {
+
+namespace {
+
+bool SameKey(const TuningEntry &lhs, const TuningEntry &rhs) {
+  return lhs.type_ == rhs.type_ &&
+    lhs.input_class_ == rhs.input_class_ &&
+    lhs.test_size_ == rhs.test_size_;
+}
+
+double LogDistance(size_t lhs, size_t rhs) {
+  return fabs(log(lhs + 1.0) - log(rhs + 1.0));
+}
+
+}  // namespace
+
+size_t MaxTunedThreads() {
+  return std::max(2u, 2 * boost::thread::hardware_concurrency());
+}
+
+void TuningProfile::Add(const TuningEntry &entry) {
+  for (size_t i = 0; i < entries_.size(); ++i) {
+    if (SameKey(entries_[i], entry)) {
+      entries_[i] = entry;
+      return;
+    }
+  }
+  entries_.push_back(entry);
+}
+
+void TuningProfile::Clear(const std::string &type) {
+  std::vector<TuningEntry> entries;
+  for (size_t i = 0; i < entries_.size(); ++i)
+    if (entries_[i].type_ != type)
+      entries.push_back(entries_[i]);
+  entries_.swap(entries);
+}
+
+const TuningEntry* TuningProfile::Find(const std::string &type,
+				       const std::string &input_class,
+				       size_t size) const {
+  const TuningEntry *best = NULL;
+  for (size_t i = 0; i < entries_.size(); ++i) {
+    const TuningEntry &entry = entries_[i];
+    if (entry.type_ != type || entry.input_class_ != input_class)
+      continue;
+    if (best == NULL ||
+	LogDistance(entry.test_size_, size) <
+	LogDistance(best->test_size_, size))
+      best = &entry;
+  }
+  return best;
+}
+
+// Profile is a text file with a line per entry:
+// type input_class test_size algorithm num_threads min_parallel_size leaf_size
+// Lines starting with '#' are comments.
+bool TuningProfile::Load(const std::string &path) {
+  std::ifstream ifs(path.c_str());
+  if (!ifs)
+    return false;
+
+  std::vector<TuningEntry> entries;
+  std::string line;
+  while (std::getline(ifs, line)) {
+    if (line.empty() || line[0] == '#')
+      continue;
+
+    std::istringstream is(line);
+    TuningEntry entry;
+    if (!(is >> entry.type_ >> entry.input_class_ >> entry.test_size_ >>
+	  entry.algorithm_ >> entry.num_threads_ >> entry.min_parallel_size_ >>
+	  entry.leaf_size_))
+      return false;
+    if (entry.leaf_size_ == 0)
+      return false;
+    entry.num_threads_ = std::min(entry.num_threads_, MaxTunedThreads());
+    entries.push_back(entry);
+  }
+
+  entries_.swap(entries);
+  return true;
+}
+
+bool TuningProfile::Save(const std::string &path) const {
+  std::ofstream ofs(path.c_str());
+  if (!ofs)
+    return false;
+
+  ofs << "# type input_class test_size algorithm num_threads "
+    "min_parallel_size leaf_size" << std::endl;
+  for (size_t i = 0; i < entries_.size(); ++i) {
+    const TuningEntry &entry = entries_[i];
+    ofs <<
+      entry.type_ << ' ' <<
+      entry.input_class_ << ' ' <<
+      entry.test_size_ << ' ' <<
+      entry.algorithm_ << ' ' <<
+      entry.num_threads_ << ' ' <<
+      entry.min_parallel_size_ << ' ' <<
+      entry.leaf_size_ << std::endl;
+  }
+  return ofs.good();
+}
+
+}  // namespace sorters
@@ -0,0 +1,56 @@
+#ifndef SORTERS_TUNING_PROFILE_H
+#define SORTERS_TUNING_PROFILE_H
+
+#include <string>
+#include <vector>
+
+
+namespace sorters {
+
+// The best algorithm with its parameters for inputs of a given element
+// type, input class and size, as measured on the current machine.
+struct TuningEntry {
+  std::string type_;
+  std::string input_class_;
+  size_t test_size_;
+  std::string algorithm_;
+  size_t num_threads_;
+  size_t min_parallel_size_;
+  size_t leaf_size_;
+}; // struct TuningEntry
+
+// Largest number of threads the tuner tries and a profile may ask for.
+size_t MaxTunedThreads();
+
+class TuningProfile {
+ public:
+  TuningProfile() {}
+
+  // Adds entry, replacing one with the same type, class and size.
+  void Add(const TuningEntry &entry);
+
+  // Removes all entries for a given type.
+  void Clear(const std::string &type);
+
+  // Returns the entry for a given type and class which size is the
+  // closest to size in log-scale, or NULL if there is no such entry.
+  const TuningEntry* Find(const std::string &type,
+			  const std::string &input_class,
+			  size_t size) const;
+
+  // Fails on malformed lines and entries with zero leaf size, and clamps
+  // the number of threads to MaxTunedThreads(), as the profile may be
+  // edited by hand.
+  bool Load(const std::string &path);
+
+  bool Save(const std::string &path) const;
+
+  const std::vector<TuningEntry>& entries() const { return entries_; }
+
+ private:
+  std::vector<TuningEntry> entries_;
+}; // class TuningProfile
+
+}  // namespace sorters
+
+#endif // #ifndef SORTERS_TUNING_PROFILE_H
@@ -1,13 +1,16 @@
 #include <assert.h>
+#include <math.h>
 #include <stdlib.h>
 #include <time.h>
 
 #include <algorithm>
+#include <deque>
 #include <fstream>
 #include <iomanip>
 #include <iostream>
 #include <iterator>
 #include <new>
+#include <sstream>
 #include <string>
 #include <vector>
 
@@ -18,14 +21,27 @@
 
 #include "base/comparer.h"
 #include "base/macros.h"
+#include "base/perf_counters.h"
+#include "base/regression_checker.h"
+#include "base/result_set.h"
 #include "base/timer.h"
 #include "base/vector.h"
+#include "generators/dataset.h"
+#include "generators/distributions.h"
 #include "generators/generator_interface.h"
 #include "generators/random_generator.h"
+#include "generators/string_generators.h"
+#include "sorters/block_merge_sorters.h"
+#include "sorters/copying_sorters.h"
+#include "sorters/dispatching_sorter.h"
+#include "sorters/heap_sorters.h"
 #include "sorters/insertion_sorter.h"
 #include "sorters/multithreaded_sorters.h"
+#include "sorters/sort_service.h"
 #include "sorters/sorter_interface.h"
 #include "sorters/stl_sorters.h"
+#include "sorters/string_radix_sorter.h"
+#include "sorters/tuning_profile.h"
 
 
 using namespace base;
@@ -39,14 +55,38 @@ namespace program_options = boost::program_options;
 typedef void (*TesterMethod) ();
 
 const int kMaxPower = 31;
-const int kMaxNumDimensions = 16;
+const int kMaxNumDimensions = kMaxDatasetDimension;
+const int kMinTunedPower = 4;
+const int kTunedPowerStep = 2;
+const size_t kTunedParallelSizes[] = { 1 << 12, 1 << 16 };
+const size_t kTunedLeafSizes[] = { 8, 16, 32 };
 
 bool FLAGS_use_insertion_sort;
 bool FLAGS_sort_pointers;
+bool FLAGS_sort_strings;
+string FLAGS_string_keys;
 int FLAGS_max_power;
 int FLAGS_seed;
 int FLAGS_num_dimensions;
+int FLAGS_num_repetitions;
+string FLAGS_distribution;
 string FLAGS_output_directory;
+bool FLAGS_autotune;
+string FLAGS_tuning_profile;
+bool FLAGS_service_benchmark;
+double FLAGS_request_rate;
+int FLAGS_num_requests;
+string FLAGS_request_sizes;
+int FLAGS_num_workers;
+int FLAGS_max_pending_jobs;
+int FLAGS_small_job_size;
+bool FLAGS_api_benchmark;
+string FLAGS_input_dataset;
+string FLAGS_dump_dataset;
+vector<string> FLAGS_compare;
+double FLAGS_regression_threshold;
+double FLAGS_significance_level;
+double FLAGS_compare_min_time;
 
 
 namespace {
@@ -56,6 +96,11 @@ struct InfoEntry {
   double generating_time_;
   double sorting_time_;
   double checking_time_;
+  vector<double> sorting_times_;
+  // Average numbers of hardware events per sorting, if counters are
+  // available.
+  bool has_perf_events_;
+  double perf_events_[kNumPerfEvents];
 }; // struct InfoEntry
 
 ostream& operator << (ostream& os, const InfoEntry& entry) {
@@ -65,6 +110,16 @@ ostream& operator << (ostream& os, const InfoEntry& entry) {
   os << "Generating time: " << entry.generating_time_ << endl;
   os << "Sorting time: " << entry.sorting_time_ << endl;
   os << "Checking time: " << entry.checking_time_ << endl;
+  os << "Sorting times:";
+  for (size_t i = 0; i < entry.sorting_times_.size(); ++i)
+    os << ' ' << entry.sorting_times_[i];
+  os << endl;
+  if (entry.has_perf_events_) {
+    os << setprecision(0);
+    os << "L1 data cache misses: " << entry.perf_events_[kL1DataMisses] << endl;
+    os << "Cache misses: " << entry.perf_events_[kCacheMisses] << endl;
+    os << "Data TLB misses: " << entry.perf_events_[kDataTlbMisses] << endl;
+  }
 
   return os;
 }
@@ -72,18 +127,127 @@ ostream& operator << (ostream& os, const InfoEntry& entry) {
 template<typename T, typename Comparer>
 void TestSortingAlgorithm(size_t size, T *data,
 			  SorterInterface<T, Comparer> &sorter,
-			  InfoEntry &entry) {
+			  PerfCounters &counters, InfoEntry &entry) {
+  counters.Start();
   Timer timer;
 
   sorter.Sort(size, data);
-  entry.sorting_time_ = timer.Elapsed();
+  entry.sorting_times_.push_back(timer.Elapsed());
+  counters.Stop();
+
+  entry.has_perf_events_ = counters.available();
+  for (int event = 0; event < kNumPerfEvents; ++event)
+    entry.perf_events_[event] += counters.Get(PerfEvent(event));
 
   Comparer comparer;
 
   timer.Restart();
   for (size_t i = 0; i + 1 < size; ++i)
     assert(!comparer(data[i + 1], data[i]));
-  entry.checking_time_ = timer.Elapsed();
+  entry.checking_time_ += timer.Elapsed();
+}
+
+template<typename T>
+class TypeName {
+ public:
+  static string Get();
+}; // class TypeName
+
+template<>
+class TypeName<int> {
+ public:
+  static string Get() {
+    return "int";
+  }
+}; // class TypeName
+
+template<size_t N>
+class TypeName<Vector<N, int> > {
+ public:
+  static string Get() {
+    ostringstream os;
+    os << "vector_" << N << "_int";
+    return os.str();
+  }
+}; // class TypeName
+
+template<typename T>
+class TypeName<T*> {
+ public:
+  static string Get() {
+    return TypeName<T>::Get() + "_ptr";
+  }
+}; // class TypeName
+
+template<>
+class TypeName<string> {
+ public:
+  static string Get() {
+    return "string";
+  }
+}; // class TypeName
+
+template<>
+class TypeName<const char*> {
+ public:
+  static string Get() {
+    return "cstring";
+  }
+}; // class TypeName
+
+template<typename T>
+GeneratorInterace<T>* CreateGenerator() {
+  return new RandomGenerator<T>();
+}
+
+template<>
+GeneratorInterace<string>* CreateGenerator<string>() {
+  return CreateStringGenerator(FLAGS_string_keys);
+}
+
+template<>
+GeneratorInterace<const char*>* CreateGenerator<const char*>() {
+  return new CStringGenerator(CreateStringGenerator(FLAGS_string_keys));
+}
+
+// Returns distribution name for result files. Kind of string keys is a
+// part of distribution.
+template<typename T>
+string GetDistributionName() {
+  return FLAGS_distribution;
+}
+
+template<>
+string GetDistributionName<string>() {
+  return FLAGS_string_keys + "_keys_" + FLAGS_distribution;
+}
+
+template<>
+string GetDistributionName<const char*>() {
+  return GetDistributionName<string>();
+}
+
+// Adds sorters which work for particular types only.
+template<typename T, typename Comparer>
+void AddTypeSpecificSorters(
+  boost::ptr_vector<SorterInterface<T, Comparer> > *sorters,
+  vector<string> *sorters_names) {
+}
+
+template<>
+void AddTypeSpecificSorters(
+  boost::ptr_vector<SorterInterface<string, less<string> > > *sorters,
+  vector<string> *sorters_names) {
+  sorters->push_back(new MsdRadixStringSorter<string, less<string> >());
+  sorters_names->push_back("msd_radix_string_sorter");
+}
+
+template<>
+void AddTypeSpecificSorters(
+  boost::ptr_vector<SorterInterface<const char*, CStringComparer> > *sorters,
+  vector<string> *sorters_names) {
+  sorters->push_back(new MsdRadixStringSorter<const char*, CStringComparer>());
+  sorters_names->push_back("msd_radix_string_sorter");
 }
 
 template<typename T>
@@ -115,6 +279,16 @@ void AllocateBuffer(size_t size, T ***buffer) {
   }
 }
 
+// C strings are owned by their generator, so only pointers are allocated.
+void AllocateBuffer(size_t size, const char ***buffer) {
+  *buffer = new (std::nothrow) const char* [size];
+  if (*buffer == NULL) {
+    clog << "AllocateBuffer: can't allocate buffer" << endl;
+    clog << "Terminating..." << endl;
+    exit(-1);
+  }
+}
+
 template<typename T>
 void DeallocateBuffer(T *buffer, size_t size) {
   delete [] buffer;
@@ -127,46 +301,132 @@ void DeallocateBuffer(T **buffer, size_t size) {
   delete [] buffer;
 }
 
+void DeallocateBuffer(const char **buffer, size_t size) {
+  delete [] buffer;
+}
+
+// Test sizes are powers of two below max_size and max_size itself.
+void GetTestSizes(size_t max_size, vector<size_t> *sizes) {
+  for (size_t size = 1; size < max_size; size *= 2)
+    sizes->push_back(size);
+  sizes->push_back(max_size);
+}
+
+// Tests sorters on prefixes of the dataset if it isn't NULL, or on
+// generated objects otherwise.
 template<typename T, typename Comparer>
 void TwoPowerTesting(GeneratorInterace<T> *generator,
+		     const MappedDataset<T> *dataset,
 		     boost::ptr_vector<SorterInterface<T, Comparer> > &sorters,
 		     vector<vector<InfoEntry> > *info) {
-  info->resize(sorters.size());
+  size_t max_size = size_t(1) << FLAGS_max_power;
+  if (dataset != NULL)
+    max_size = min(max_size, dataset->size());
 
-  for (size_t cur_sorter = 0; cur_sorter < sorters.size(); ++cur_sorter)
-    (*info)[cur_sorter].resize(FLAGS_max_power + 1);
+  vector<size_t> sizes;
+  GetTestSizes(max_size, &sizes);
 
-  Timer timer;
+  info->resize(sorters.size());
 
-  for (int power = 0; power <= FLAGS_max_power; ++power) {
-    const size_t size = 1 << power;
+  for (size_t cur_sorter = 0; cur_sorter < sorters.size(); ++cur_sorter)
+    (*info)[cur_sorter].resize(sizes.size());
 
-    clog << "Testing on a buffer of size " << size << " ..." << endl;
+  for (size_t cur_sorter = 0; cur_sorter < sorters.size(); ++cur_sorter)
+    for (size_t cur_size = 0; cur_size < sizes.size(); ++cur_size) {
+      InfoEntry &entry = (*info)[cur_sorter][cur_size];
+      entry.test_size_ = sizes[cur_size];
+      entry.generating_time_ = 0.0;
+      entry.checking_time_ = 0.0;
+      entry.sorting_times_.clear();
+      fill(entry.perf_events_, entry.perf_events_ + kNumPerfEvents, 0.0);
+    }
 
-    T *data, *buffer;
-    AllocateBuffer(size, &data);
-    buffer = new T [size];
+  Timer timer;
+  PerfCounters counters;
+
+  // Each repetition is a pass over all sizes and sorters on a freshly
+  // generated input, so samples of an entry are taken far apart in time
+  // and a burst of background load hits at most one of them.
+  for (int repetition = 0; repetition < FLAGS_num_repetitions;
+       ++repetition) {
+    for (size_t cur_size = 0; cur_size < sizes.size(); ++cur_size) {
+      const size_t size = sizes[cur_size];
+
+      clog << "Testing on a buffer of size " << size << " ..." << endl;
+
+      const T *input;
+      T *data = NULL, *buffer;
+      buffer = new T [size];
+
+      timer.Restart();
+      if (dataset != NULL) {
+	input = dataset->objects();
+      } else {
+	AllocateBuffer(size, &data);
+	for (size_t i = 0; i < size; ++i)
+	  generator->Generate(&data[i]);
+	ApplyDistribution<T, Comparer>(FLAGS_distribution, size, data);
+	input = data;
+      }
+      double generating_time = timer.Elapsed();
+
+      for (size_t cur_sorter = 0; cur_sorter < sorters.size(); ++cur_sorter) {
+	InfoEntry &entry = (*info)[cur_sorter][cur_size];
+	entry.generating_time_ += generating_time;
+
+	std::copy(input, input + size, buffer);
+	TestSortingAlgorithm(size, buffer, sorters[cur_sorter], counters,
+			     entry);
+      }
+
+      if (data != NULL) {
+	DeallocateBuffer(data, size);
+	generator->ReleaseObjects();
+      }
+      delete [] buffer;
+    }
+  }
 
-    timer.Restart();
-    for (size_t i = 0; i < size; ++i)
-      generator->Generate(&data[i]);
-    double generating_time = timer.Elapsed();
+  for (size_t cur_sorter = 0; cur_sorter < sorters.size(); ++cur_sorter)
+    for (size_t cur_size = 0; cur_size < sizes.size(); ++cur_size) {
+      InfoEntry &entry = (*info)[cur_sorter][cur_size];
+      entry.sorting_time_ = 0.0;
+      for (int repetition = 0; repetition < FLAGS_num_repetitions;
+	   ++repetition)
+	entry.sorting_time_ += entry.sorting_times_[repetition];
+      entry.sorting_time_ /= FLAGS_num_repetitions;
+      entry.generating_time_ /= FLAGS_num_repetitions;
+      entry.checking_time_ /= FLAGS_num_repetitions;
+      for (int event = 0; event < kNumPerfEvents; ++event)
+	entry.perf_events_[event] /= FLAGS_num_repetitions;
+    }
+}
 
-    for (size_t cur_sorter = 0; cur_sorter < sorters.size(); ++cur_sorter) {
-      (*info)[cur_sorter][power].test_size_ = size;
-      (*info)[cur_sorter][power].generating_time_ = generating_time;
+// Writes 2^FLAGS_max_power generated objects to FLAGS_dump_dataset, so
+// they can be replayed by --input_dataset on any machine.
+template<typename T, typename Comparer>
+void DumpDataset(GeneratorInterace<T> *generator) {
+  const size_t size = size_t(1) << FLAGS_max_power;
 
-      std::copy(data, data + size, buffer);
-      TestSortingAlgorithm(size, buffer, sorters[cur_sorter],
-			   (*info)[cur_sorter][power]);
-    }
+  T *data;
+  AllocateBuffer(size, &data);
+  for (size_t i = 0; i < size; ++i)
+    generator->Generate(&data[i]);
+  ApplyDistribution<T, Comparer>(FLAGS_distribution, size, data);
 
-    DeallocateBuffer(data, size);
-    delete [] buffer;
+  if (!WriteDataset(FLAGS_dump_dataset, size, data)) {
+    clog << "DumpDataset: can't write " << FLAGS_dump_dataset << endl;
+    clog << "Terminating..." << endl;
+    exit(-1);
   }
+
+  DeallocateBuffer(data, size);
+  generator->ReleaseObjects();
 }
 
 void DumpStatistic(const string &out_dir,
+		   const string &type_name,
+		   const string &distribution,
 		   const vector<string> &sorters_names,
 		   const vector<vector<InfoEntry> > &info) {
   if (info.empty())
@@ -179,6 +439,12 @@ void DumpStatistic(const string &out_dir,
 
   filesystem::path output_directory(out_dir);
 
+  ResultSet result_set;
+  CollectMachineMetadata(&result_set.metadata_);
+  result_set.metadata_.seed_ = FLAGS_seed;
+  result_set.metadata_.max_power_ = FLAGS_max_power;
+  result_set.metadata_.num_repetitions_ = FLAGS_num_repetitions;
+
   for (size_t i = 0; i < sorters_names.size(); ++i) {
     CHECK_EQ(m, info[i].size());
 
@@ -204,12 +470,489 @@ void DumpStatistic(const string &out_dir,
       copy(info[i].begin(), info[i].end(),
 	   ostream_iterator<InfoEntry>(ofs, "\n"));
     }
+
+    for (size_t j = 0; j < m; ++j) {
+      ResultEntry entry;
+      entry.sorter_ = sorters_names[i];
+      entry.type_ = type_name;
+      entry.distribution_ = distribution;
+      entry.test_size_ = info[i][j].test_size_;
+      entry.generating_time_ = info[i][j].generating_time_;
+      entry.sorting_time_ = info[i][j].sorting_time_;
+      entry.checking_time_ = info[i][j].checking_time_;
+      entry.sorting_times_ = info[i][j].sorting_times_;
+      entry.has_perf_events_ = info[i][j].has_perf_events_;
+      entry.l1_data_misses_ = info[i][j].perf_events_[kL1DataMisses];
+      entry.cache_misses_ = info[i][j].perf_events_[kCacheMisses];
+      entry.data_tlb_misses_ = info[i][j].perf_events_[kDataTlbMisses];
+      result_set.entries_.push_back(entry);
+    }
   }
+
+  filesystem::path json_path = output_directory / kResultsJsonFileName;
+  if (!DumpJson(result_set, json_path.string()))
+    clog << "DumpStatistic: can't write " << json_path.string() << endl;
+
+  filesystem::path csv_path = output_directory / kResultsCsvFileName;
+  if (!DumpCsv(result_set, csv_path.string()))
+    clog << "DumpStatistic: can't write " << csv_path.string() << endl;
+}
+
+void FillTuningCandidates(vector<TuningEntry> *candidates) {
+  const size_t num_leaf_sizes =
+    sizeof(kTunedLeafSizes) / sizeof(kTunedLeafSizes[0]);
+  const size_t num_parallel_sizes =
+    sizeof(kTunedParallelSizes) / sizeof(kTunedParallelSizes[0]);
+  const size_t max_threads = MaxTunedThreads();
+
+  TuningEntry entry;
+  entry.num_threads_ = 0;
+  entry.min_parallel_size_ = 0;
+  entry.leaf_size_ = kBlockMergeInsertionRun;
+
+  entry.algorithm_ = kStlBasicAlgorithm;
+  candidates->push_back(entry);
+
+  entry.algorithm_ = kStlStableAlgorithm;
+  candidates->push_back(entry);
+
+  entry.algorithm_ = kBlockMergeAlgorithm;
+  for (size_t i = 0; i < num_leaf_sizes; ++i) {
+    entry.leaf_size_ = kTunedLeafSizes[i];
+    candidates->push_back(entry);
+  }
+  entry.leaf_size_ = kBlockMergeInsertionRun;
+
+  for (size_t num_threads = 1; num_threads <= max_threads; num_threads *= 2) {
+    for (size_t i = 0; i < num_parallel_sizes; ++i) {
+      entry.num_threads_ = num_threads;
+      entry.min_parallel_size_ = kTunedParallelSizes[i];
+
+      entry.algorithm_ = kMultithreadedQuickAlgorithm;
+      candidates->push_back(entry);
+
+      entry.algorithm_ = kParallelBlockMergeAlgorithm;
+      candidates->push_back(entry);
+    }
+  }
+}
+
+// Measures every tuning candidate on every distribution and on sizes
+// from 2^kMinTunedPower to 2^FLAGS_max_power, and stores the fastest
+// ones for the current type in FLAGS_tuning_profile.
+template<typename T, typename Comparer>
+void AutotuneSorters(GeneratorInterace<T> *generator) {
+  const string type_name = TypeName<T>::Get();
+
+  TuningProfile profile;
+  if (filesystem::exists(FLAGS_tuning_profile) &&
+      !profile.Load(FLAGS_tuning_profile)) {
+    clog << "AutotuneSorters: can't parse " << FLAGS_tuning_profile << endl;
+    clog << "Terminating..." << endl;
+    exit(-1);
+  }
+  profile.Clear(type_name);
+
+  vector<TuningEntry> candidates;
+  FillTuningCandidates(&candidates);
+
+  int min_power = min(kMinTunedPower, FLAGS_max_power);
+  min_power += (FLAGS_max_power - min_power) % kTunedPowerStep;
+
+  Timer timer;
+  Comparer comparer;
+
+  for (size_t cur_distribution = 0; cur_distribution < kNumDistributions;
+       ++cur_distribution) {
+    const string distribution = kDistributions[cur_distribution];
+
+    for (int power = min_power; power <= FLAGS_max_power;
+	 power += kTunedPowerStep) {
+      const size_t size = size_t(1) << power;
+
+      T *data, *buffer;
+      AllocateBuffer(size, &data);
+      buffer = new T [size];
+
+      for (size_t i = 0; i < size; ++i)
+	generator->Generate(&data[i]);
+      ApplyDistribution<T, Comparer>(distribution, size, data);
+
+      size_t best_candidate = 0;
+      double best_time = 0.0;
+      for (size_t cur_candidate = 0; cur_candidate < candidates.size();
+	   ++cur_candidate) {
+	const TuningEntry &candidate = candidates[cur_candidate];
+	if (candidate.min_parallel_size_ > size)
+	  continue;
+
+	boost::scoped_ptr<SorterInterface<T, Comparer> >
+	  sorter(CreateSorter<T, Comparer>(candidate));
+	assert(sorter);
+
+	double time = 0.0;
+	for (int repetition = 0; repetition < FLAGS_num_repetitions;
+	     ++repetition) {
+	  std::copy(data, data + size, buffer);
+	  timer.Restart();
+	  sorter->Sort(size, buffer);
+	  double elapsed = timer.Elapsed();
+	  if (repetition == 0 || elapsed < time)
+	    time = elapsed;
+
+	  for (size_t i = 0; i + 1 < size; ++i)
+	    assert(!comparer(buffer[i + 1], buffer[i]));
+	}
+
+	if (cur_candidate == 0 || time < best_time) {
+	  best_candidate = cur_candidate;
+	  best_time = time;
+	}
+      }
+
+      TuningEntry entry = candidates[best_candidate];
+      entry.type_ = type_name;
+      entry.input_class_ = distribution;
+      entry.test_size_ = size;
+      profile.Add(entry);
+
+      clog << setprecision(6) << fixed <<
+	distribution << " " << size << ": " << entry.algorithm_ <<
+	" threads=" << entry.num_threads_ <<
+	" min_parallel_size=" << entry.min_parallel_size_ <<
+	" leaf_size=" << entry.leaf_size_ <<
+	" time=" << best_time << endl;
+
+      DeallocateBuffer(data, size);
+      generator->ReleaseObjects();
+      delete [] buffer;
+    }
+  }
+
+  if (!profile.Save(FLAGS_tuning_profile)) {
+    clog << "AutotuneSorters: can't write " << FLAGS_tuning_profile << endl;
+    clog << "Terminating..." << endl;
+    exit(-1);
+  }
+}
+
+// Parses comma-separated list of size:weight pairs.
+bool ParseRequestSizes(const string &request_sizes,
+		       vector<size_t> *sizes, vector<double> *weights) {
+  istringstream is(request_sizes);
+  string item;
+  while (getline(is, item, ',')) {
+    istringstream item_is(item);
+    size_t size;
+    double weight;
+    char separator;
+    if (!(item_is >> size >> separator >> weight) || separator != ':' ||
+	size == 0 || weight <= 0.0)
+      return false;
+    sizes->push_back(size);
+    weights->push_back(weight);
+  }
+  return !sizes->empty();
+}
+
+template<typename T, typename Comparer>
+SorterInterface<T, Comparer>* CreateServiceSorter() {
+  return new StlBasicSorter<T, Comparer>();
+}
+
+template<typename T>
+struct ServiceRequest {
+  size_t size_;
+  T *objects_;
+  // Delay between scheduled and actual submission.
+  double lag_;
+  boost::shared_future<SortResult> result_;
+}; // struct ServiceRequest
+
+// Frees finished requests from the front of the queue, or all requests
+// if wait is set.
+template<typename T, typename Comparer>
+void CollectServiceRequests(bool wait, deque<ServiceRequest<T> > *requests,
+			    vector<double> *latencies, size_t *num_rejected) {
+  Comparer comparer;
+
+  while (!requests->empty() && (wait || requests->front().result_.is_ready())) {
+    ServiceRequest<T> &request = requests->front();
+    const SortResult &result = request.result_.get();
+
+    if (result.status_ == kRejected) {
+      ++*num_rejected;
+    } else {
+      latencies->push_back(request.lag_ + result.queue_time_ +
+			   result.sorting_time_);
+      for (size_t i = 0; i + 1 < request.size_; ++i)
+	assert(!comparer(request.objects_[i + 1], request.objects_[i]));
+    }
+
+    delete [] request.objects_;
+    requests->pop_front();
+  }
+}
+
+double Percentile(const vector<double> &sorted_values, double quantile) {
+  if (sorted_values.empty())
+    return 0.0;
+  size_t rank = static_cast<size_t>(ceil(quantile * sorted_values.size()));
+  return sorted_values[min(max(rank, size_t(1)), sorted_values.size()) - 1];
+}
+
+// Submits FLAGS_num_requests sorting requests to SortService as a
+// Poisson process with FLAGS_request_rate requests per second, with
+// sizes drawn from FLAGS_request_sizes, and reports throughput and
+// latency percentiles. Latency is counted from the scheduled submission
+// time, so a lagging load generator doesn't hide queueing.
+template<typename T, typename Comparer>
+void BenchmarkSortService(GeneratorInterace<T> *generator) {
+  vector<size_t> sizes;
+  vector<double> weights;
+  if (!ParseRequestSizes(FLAGS_request_sizes, &sizes, &weights)) {
+    clog << "BenchmarkSortService: can't parse request sizes " <<
+      FLAGS_request_sizes << endl;
+    clog << "Terminating..." << endl;
+    exit(-1);
+  }
+
+  double total_weight = 0.0;
+  vector<T*> sources(sizes.size());
+  for (size_t i = 0; i < sizes.size(); ++i) {
+    total_weight += weights[i];
+    AllocateBuffer(sizes[i], &sources[i]);
+    for (size_t j = 0; j < sizes[i]; ++j)
+      generator->Generate(&sources[i][j]);
+    ApplyDistribution<T, Comparer>(FLAGS_distribution, sizes[i], sources[i]);
+  }
+
+  SortServiceOptions options;
+  options.num_workers_ = FLAGS_num_workers > 0 ?
+    FLAGS_num_workers : max(1u, boost::thread::hardware_concurrency());
+  options.max_pending_jobs_ = FLAGS_max_pending_jobs;
+  options.small_job_size_ = FLAGS_small_job_size;
+  options.max_small_streak_ = 4;
+
+  vector<double> latencies;
+  size_t num_rejected = 0;
+  double duration;
+
+  {
+    SortService<T, Comparer> service(options,
+				     &CreateServiceSorter<T, Comparer>);
+    deque<ServiceRequest<T> > requests;
+
+    Timer timer;
+    double scheduled_time = 0.0;
+    for (int i = 0; i < FLAGS_num_requests; ++i) {
+      const double uniform = (rand() + 1.0) / (RAND_MAX + 2.0);
+      scheduled_time += -log(uniform) / FLAGS_request_rate;
+
+      const double current_time = timer.Elapsed();
+      if (current_time < scheduled_time)
+	boost::this_thread::sleep_for(
+	  boost::chrono::duration<double>(scheduled_time - current_time));
+
+      double point = total_weight * rand() / (RAND_MAX + 1.0);
+      size_t kind = 0;
+      while (kind + 1 < sizes.size() && point >= weights[kind])
+	point -= weights[kind++];
+
+      ServiceRequest<T> request;
+      request.size_ = sizes[kind];
+      request.objects_ = new T [request.size_];
+      std::copy(sources[kind], sources[kind] + request.size_,
+		request.objects_);
+      request.lag_ = max(0.0, timer.Elapsed() - scheduled_time);
+      request.result_ = service.Submit(request.size_, request.objects_);
+      requests.push_back(request);
+
+      CollectServiceRequests<T, Comparer>(false, &requests,
+					  &latencies, &num_rejected);
+    }
+
+    CollectServiceRequests<T, Comparer>(true, &requests,
+					&latencies, &num_rejected);
+    duration = timer.Elapsed();
+  }
+
+  for (size_t i = 0; i < sizes.size(); ++i)
+    DeallocateBuffer(sources[i], sizes[i]);
+  generator->ReleaseObjects();
+
+  sort(latencies.begin(), latencies.end());
+
+  cout << setprecision(6) << fixed;
+  cout << "Workers: " << options.num_workers_ << endl;
+  cout << "Requests: " << FLAGS_num_requests << endl;
+  cout << "Rejected: " << num_rejected << endl;
+  cout << "Duration: " << duration << endl;
+  cout << "Throughput: " << latencies.size() / duration << endl;
+  cout << "Latency p50: " << Percentile(latencies, 0.5) << endl;
+  cout << "Latency p99: " << Percentile(latencies, 0.99) << endl;
+  cout << "Latency p999: " << Percentile(latencies, 0.999) << endl;
+}
+
+// Returns time of sorting data split into arrays of array_size objects
+// by algorithm with comparison.
+template<typename T, typename Algorithm, typename Comparison>
+double MeasureSorting(size_t size, const T *data, size_t array_size,
+		      T *buffer, const Algorithm &algorithm,
+		      Comparison comparison) {
+  std::copy(data, data + size, buffer);
+
+  Timer timer;
+  for (size_t i = 0; i < size; i += array_size)
+    algorithm(buffer + i, buffer + min(i + array_size, size), comparison);
+  return timer.Elapsed();
+}
+
+// Returns minimum times of sorting data by the baseline and by the
+// candidate over FLAGS_num_repetitions runs. Variants take turns to run
+// first, and an untimed run of each warms up the buffer and caches.
+template<typename T, typename Baseline, typename BaselineComparison,
+	 typename Candidate, typename CandidateComparison>
+void MeasurePair(size_t size, const T *data, size_t array_size, T *buffer,
+		 const Baseline &baseline,
+		 BaselineComparison baseline_comparison,
+		 const Candidate &candidate,
+		 CandidateComparison candidate_comparison,
+		 double *baseline_time, double *candidate_time) {
+  MeasureSorting(size, data, array_size, buffer, baseline,
+		 baseline_comparison);
+  MeasureSorting(size, data, array_size, buffer, candidate,
+		 candidate_comparison);
+
+  for (int repetition = 0; repetition < FLAGS_num_repetitions;
+       ++repetition) {
+    double first, second;
+    if (repetition % 2 == 0) {
+      first = MeasureSorting(size, data, array_size, buffer, baseline,
+			     baseline_comparison);
+      second = MeasureSorting(size, data, array_size, buffer, candidate,
+			      candidate_comparison);
+    } else {
+      second = MeasureSorting(size, data, array_size, buffer, candidate,
+			      candidate_comparison);
+      first = MeasureSorting(size, data, array_size, buffer, baseline,
+			     baseline_comparison);
+    }
+    if (repetition == 0 || first < *baseline_time)
+      *baseline_time = first;
+    if (repetition == 0 || second < *candidate_time)
+      *candidate_time = second;
+  }
+}
+
+template<typename T, typename Comparer>
+bool CompareObjects(const T &lhs, const T &rhs) {
+  return Comparer()(lhs, rhs);
+}
+
+// Compares an algorithm which copies objects with the one which moves
+// them, on arrays of growing size up to max_array_size.
+template<typename T, typename Comparer, typename Copying, typename Moving>
+void ReportMoves(const string &name, size_t max_array_size, size_t size,
+		 const T *data, T *buffer) {
+  for (size_t array_size = 4; array_size <= max_array_size; array_size *= 4) {
+    double copy_time = 0.0, move_time = 0.0;
+    MeasurePair(size, data, array_size, buffer, Copying(), Comparer(),
+		Moving(), Comparer(), &copy_time, &move_time);
+    cout << setprecision(6) << fixed <<
+      name << " " << array_size << ": copy " << copy_time <<
+      " move " << move_time << endl;
+  }
+}
+
+// Compares algorithm called with a function pointer, which can't be
+// inlined, with algorithm called with the comparer object.
+template<typename T, typename Comparer, typename Algorithm>
+void ReportInlining(const string &name, size_t size, const T *data,
+		    T *buffer) {
+  // Volatile keeps compiler from propagating the constant pointer into
+  // the algorithm.
+  bool (* volatile function)(const T&, const T&) =
+    &CompareObjects<T, Comparer>;
+  bool (*comparison)(const T&, const T&) = function;
+
+  for (size_t array_size = 4; array_size <= size; array_size *= 16) {
+    double pointer_time = 0.0, functor_time = 0.0;
+    MeasurePair(size, data, array_size, buffer, Algorithm(), comparison,
+		Algorithm(), Comparer(), &pointer_time, &functor_time);
+    cout << setprecision(6) << fixed <<
+      name << " " << array_size << ": function_pointer " << pointer_time <<
+      " functor " << functor_time << endl;
+  }
+}
+
+// Measures gains of the sorter API on 2^FLAGS_max_power objects split
+// into arrays of growing size: moves against copying baselines, and
+// inlined comparers against function pointers. Reported times are the
+// minimum over FLAGS_num_repetitions runs. Moves matter for types
+// with expensive copies, like std::string, and don't for trivially
+// copyable Vector<N, int>. Insertion sort is limited to arrays of up
+// to 2^10 objects.
+template<typename T, typename Comparer>
+void BenchmarkStaticApi(GeneratorInterace<T> *generator) {
+  const size_t size = size_t(1) << FLAGS_max_power;
+
+  T *data, *buffer;
+  AllocateBuffer(size, &data);
+  buffer = new T [size];
+
+  for (size_t i = 0; i < size; ++i)
+    generator->Generate(&data[i]);
+  ApplyDistribution<T, Comparer>(FLAGS_distribution, size, data);
+
+  ReportMoves<T, Comparer, CopyingInsertionSort, InsertionSort>(
+    "insertion_sort", min(size, size_t(1) << 10), size, data, buffer);
+  ReportMoves<T, Comparer, CopyingPartitionSort, StlPartitionSort>(
+    "partition_sort", size, size, data, buffer);
+  ReportInlining<T, Comparer, StlSort>("stl_sort", size, data, buffer);
+  ReportInlining<T, Comparer, BlockMergeSort>("block_merge_sort", size,
+					      data, buffer);
+
+  DeallocateBuffer(data, size);
+  generator->ReleaseObjects();
+  delete [] buffer;
 }
 
 template<typename T, typename Comparer>
 void TestSortingAlgorithms() {
-  boost::scoped_ptr<GeneratorInterace<T> > generator(new RandomGenerator<T>());
+  boost::scoped_ptr<GeneratorInterace<T> > generator(CreateGenerator<T>());
+
+  if (FLAGS_autotune) {
+    AutotuneSorters<T, Comparer>(generator.get());
+    return;
+  }
+
+  if (FLAGS_service_benchmark) {
+    BenchmarkSortService<T, Comparer>(generator.get());
+    return;
+  }
+
+  if (FLAGS_api_benchmark) {
+    BenchmarkStaticApi<T, Comparer>(generator.get());
+    return;
+  }
+
+  if (!FLAGS_dump_dataset.empty()) {
+    DumpDataset<T, Comparer>(generator.get());
+    return;
+  }
+
+  MappedDataset<T> dataset;
+  string distribution = GetDistributionName<T>();
+  if (!FLAGS_input_dataset.empty()) {
+    if (!dataset.Open(FLAGS_input_dataset)) {
+      clog << "Can't load dataset " << FLAGS_input_dataset << endl;
+      clog << "Terminating..." << endl;
+      exit(-1);
+    }
+    distribution = "dataset_" +
+      filesystem::path(FLAGS_input_dataset).stem().string();
+  }
 
   boost::ptr_vector<SorterInterface<T, Comparer> > sorters;
   vector<string> sorters_names;
@@ -223,11 +966,29 @@ void TestSortingAlgorithms() {
   sorters.push_back(new StlHeapSorter<T, Comparer>());
   sorters_names.push_back("stl_heap_sorter");
 
+  sorters.push_back(new DaryHeapSorter<T, Comparer, 4>());
+  sorters_names.push_back("dary_heap_sorter_4");
+
+  sorters.push_back(new DaryHeapSorter<T, Comparer, 8>());
+  sorters_names.push_back("dary_heap_sorter_8");
+
+  sorters.push_back(new DaryHeapSorter<T, Comparer, 4>(4));
+  sorters_names.push_back("parallel_dary_heap_sorter_4");
+
   sorters.push_back(new StlPartitionSorter<T, Comparer>());
   sorters_names.push_back("stl_partition_sorter");
 
-  sorters.push_back(new StlInplacePartitionSorter<T, Comparer>());
-  sorters_names.push_back("stl_inplace_partition_sorter");
+  sorters.push_back(new BlockMergeSorter<T, Comparer>());
+  sorters_names.push_back("block_merge_sorter");
+
+  sorters.push_back(new ParallelBlockMergeSorter<T, Comparer>(2));
+  sorters_names.push_back("parallel_block_merge_sorter_2");
+
+  sorters.push_back(new ParallelBlockMergeSorter<T, Comparer>(4));
+  sorters_names.push_back("parallel_block_merge_sorter_4");
+
+  sorters.push_back(new ParallelBlockMergeSorter<T, Comparer>(8));
+  sorters_names.push_back("parallel_block_merge_sorter_8");
 
   sorters.push_back(new MultithreadedRandomizedQuickSorter<T, Comparer>(0));
   sorters_names.push_back("multithreaded_randomized_quick_sorter_0");
@@ -241,15 +1002,30 @@ void TestSortingAlgorithms() {
   sorters.push_back(new MultithreadedRandomizedQuickSorter<T, Comparer>(8));
   sorters_names.push_back("multithreaded_randomized_quick_sorter_8");
 
+  AddTypeSpecificSorters(&sorters, &sorters_names);
+
   if (FLAGS_use_insertion_sort) {
     sorters.push_back(new InsertionSorter<T, Comparer>());
     sorters_names.push_back("insertion_sorter");
   }
 
+  TuningProfile profile;
+  if (!FLAGS_tuning_profile.empty()) {
+    if (profile.Load(FLAGS_tuning_profile)) {
+      sorters.push_back(new DispatchingSorter<T, Comparer>(profile,
+							   TypeName<T>::Get()));
+      sorters_names.push_back("dispatching_sorter");
+    } else {
+      clog << "Can't load tuning profile " << FLAGS_tuning_profile << endl;
+    }
+  }
+
   vector<vector<InfoEntry> > info;
 
-  TwoPowerTesting(generator.get(), sorters, &info);
-  DumpStatistic(FLAGS_output_directory, sorters_names, info);
+  TwoPowerTesting(generator.get(),
+		  FLAGS_input_dataset.empty() ? NULL : &dataset, sorters, &info);
+  DumpStatistic(FLAGS_output_directory, TypeName<T>::Get(), distribution,
+		sorters_names, info);
 }
 
 template<size_t N, size_t I>
@@ -283,6 +1059,26 @@ void FillMethodsTable(TesterMethod *plain_methods, TesterMethod *ptr_methods) {
   }
 }
 
+int CompareResults(const string &baseline_path,
+		   const string &candidate_path) {
+  ResultSet baseline, candidate;
+  if (!LoadJson(baseline_path, &baseline)) {
+    clog << "Can't load results from " << baseline_path << endl;
+    return 2;
+  }
+  if (!LoadJson(candidate_path, &candidate)) {
+    clog << "Can't load results from " << candidate_path << endl;
+    return 2;
+  }
+
+  RegressionCheckerOptions options;
+  options.threshold_ = FLAGS_regression_threshold;
+  options.significance_level_ = FLAGS_significance_level;
+  options.min_time_ = FLAGS_compare_min_time;
+
+  return CheckRegressions(baseline, candidate, options, cout) == 0 ? 0 : 1;
+}
+
 }  // namespace
 
 int main(int argc, char **argv) {
@@ -295,6 +1091,12 @@ int main(int argc, char **argv) {
     ("sort_pointers",
      program_options::value<bool>(&FLAGS_sort_pointers)->default_value(false),
      "sort pointers to objects instead of objects")
+    ("sort_strings",
+     program_options::value<bool>(&FLAGS_sort_strings)->default_value(false),
+     "sort std::string keys, or const char* keys if --sort_pointers is set, instead of ints and vectors")
+    ("string_keys",
+     program_options::value<string>(&FLAGS_string_keys)->default_value(kRandomStringKeys),
+     "kind of string keys: random, shared_prefix or dictionary")
     ("max_power,m",
      program_options::value<int>(&FLAGS_max_power)->default_value(24),
      "maximum power of two that will be used as maximum test size. Must be from [0 .. 31].")
@@ -304,9 +1106,63 @@ int main(int argc, char **argv) {
     ("num_dimensions,n",
      program_options::value<int>(&FLAGS_num_dimensions)->default_value(0),
      "number of vector dimensions, if zero, plain ints will be sorted. Must be from [0 .. 16].")
+    ("num_repetitions,r",
+     program_options::value<int>(&FLAGS_num_repetitions)->default_value(1),
+     "number of times each sorter is run on each input")
+    ("distribution,d",
+     program_options::value<string>(&FLAGS_distribution)->default_value(kRandomDistribution),
+     "distribution of input data: random, nearly_sorted, reversed or few_unique")
+    ("autotune",
+     program_options::value<bool>(&FLAGS_autotune)->default_value(false),
+     "instead of testing, find the best sorters for the current type and write them to --tuning_profile")
+    ("tuning_profile,t",
+     program_options::value<string>(&FLAGS_tuning_profile)->default_value(""),
+     "tuning profile file; if set, dispatching sorter which uses it is tested too")
+    ("service_benchmark",
+     program_options::value<bool>(&FLAGS_service_benchmark)->default_value(false),
+     "instead of testing, measure throughput and latency of sort service under load")
+    ("request_rate",
+     program_options::value<double>(&FLAGS_request_rate)->default_value(1000.0),
+     "service benchmark: average number of requests per second")
+    ("num_requests",
+     program_options::value<int>(&FLAGS_num_requests)->default_value(10000),
+     "service benchmark: total number of requests")
+    ("request_sizes",
+     program_options::value<string>(&FLAGS_request_sizes)->default_value("256:90,65536:9,1048576:1"),
+     "service benchmark: comma-separated size:weight pairs")
+    ("num_workers",
+     program_options::value<int>(&FLAGS_num_workers)->default_value(0),
+     "service benchmark: number of workers, if zero, number of cores is used")
+    ("max_pending_jobs",
+     program_options::value<int>(&FLAGS_max_pending_jobs)->default_value(1024),
+     "service benchmark: requests submitted when this many are pending are rejected")
+    ("small_job_size",
+     program_options::value<int>(&FLAGS_small_job_size)->default_value(4096),
+     "service benchmark: requests not larger than this are served first")
+    ("api_benchmark",
+     program_options::value<bool>(&FLAGS_api_benchmark)->default_value(false),
+     "instead of testing, compare moving sorters with copying ones and inlined comparers with function pointers")
+    ("input_dataset,i",
+     program_options::value<string>(&FLAGS_input_dataset)->default_value(""),
+     "test on objects from a binary dataset instead of generated ones; its header sets --sort_strings and --num_dimensions")
+    ("dump_dataset",
+     program_options::value<string>(&FLAGS_dump_dataset)->default_value(""),
+     "instead of testing, write 2^max_power generated objects to a binary dataset")
     ("output_directory,o",
      program_options::value<string>(&FLAGS_output_directory)->default_value("out"),
      "output directory for storing test info")
+    ("compare",
+     program_options::value<vector<string> >(&FLAGS_compare)->multitoken(),
+     "compare two result sets (directories or json files): baseline and candidate. Exits with non-zero code if candidate has regressions.")
+    ("regression_threshold",
+     program_options::value<double>(&FLAGS_regression_threshold)->default_value(0.05),
+     "minimum relative slowdown treated as a regression")
+    ("significance_level",
+     program_options::value<double>(&FLAGS_significance_level)->default_value(0.05),
+     "family-wise significance level of Welch's t-tests for slowdowns above threshold, Holm-Bonferroni corrected")
+    ("compare_min_time",
+     program_options::value<double>(&FLAGS_compare_min_time)->default_value(1e-4),
+     "sorting times below this value (in seconds) are not compared")
     ;
   program_options::variables_map vm;
   program_options::store(program_options::
@@ -318,18 +1174,52 @@ int main(int argc, char **argv) {
     return 1;
   }
 
+  if (!FLAGS_compare.empty()) {
+    if (FLAGS_compare.size() != 2) {
+      clog << "--compare requires exactly two result sets" << endl;
+      return 2;
+    }
+    return CompareResults(FLAGS_compare[0], FLAGS_compare[1]);
+  }
+
+  if (!FLAGS_input_dataset.empty()) {
+    DatasetHeader header;
+    if (!ReadDatasetHeader(FLAGS_input_dataset, &header)) {
+      clog << "Can't read dataset header from " << FLAGS_input_dataset << endl;
+      return 2;
+    }
+    FLAGS_sort_strings = header.type_ == string(kStringDatasetType);
+    FLAGS_num_dimensions = header.dimension_;
+    clog << "Dataset: " << header.count_ << " objects" << endl;
+  }
+
   assert(FLAGS_output_directory != "");
   assert(FLAGS_max_power >= 0);
   assert(FLAGS_max_power <= kMaxPower);
   assert(FLAGS_num_dimensions >= 0);
   assert(FLAGS_num_dimensions <= kMaxNumDimensions);
+  assert(FLAGS_num_repetitions > 0);
+  assert(IsKnownDistribution(FLAGS_distribution));
+  assert(FLAGS_string_keys == kRandomStringKeys ||
+	 FLAGS_string_keys == kSharedPrefixStringKeys ||
+	 FLAGS_string_keys == kDictionaryStringKeys);
+  assert(!FLAGS_autotune || FLAGS_tuning_profile != "");
+  assert(FLAGS_request_rate > 0.0);
+  assert(FLAGS_num_requests >= 0);
+  assert(FLAGS_max_pending_jobs > 0);
+  assert(FLAGS_input_dataset.empty() ||
+	 (!FLAGS_autotune && !FLAGS_service_benchmark && !FLAGS_api_benchmark &&
+	  FLAGS_dump_dataset.empty()));
 
   if (FLAGS_seed == 0)
     FLAGS_seed = time(NULL);
   srand(FLAGS_seed);
 
   clog << "Maximum test size: " << (1 << FLAGS_max_power) << endl;
-  if (FLAGS_sort_pointers) {
+  if (FLAGS_sort_strings) {
+    clog << (FLAGS_sort_pointers ? "C strings" : "Strings") <<
+      " with " << FLAGS_string_keys << " keys will be sorted" << endl;
+  } else if (FLAGS_sort_pointers) {
     if (FLAGS_num_dimensions == 0)
       clog << "Pointers to ints will be sorted" << endl;
     else
@@ -342,6 +1232,7 @@ int main(int argc, char **argv) {
       clog << "Vectors of size " << FLAGS_num_dimensions <<
 	" will be sorted" << endl;
   }
+  clog << "Distribution: " << FLAGS_distribution << endl;
   clog << "Current seed: " << FLAGS_seed << endl;
 
   filesystem::path output_directory(FLAGS_output_directory);
@@ -354,7 +1245,12 @@ int main(int argc, char **argv) {
   TesterMethod ptr_methods[kMaxNumDimensions + 1];
   FillMethodsTable<kMaxNumDimensions + 1>(plain_methods, ptr_methods);
 
-  if (!FLAGS_sort_pointers)
+  if (FLAGS_sort_strings) {
+    if (!FLAGS_sort_pointers)
+      TestSortingAlgorithms<string, less<string> >();
+    else
+      TestSortingAlgorithms<const char*, CStringComparer>();
+  } else if (!FLAGS_sort_pointers)
     (*plain_methods[FLAGS_num_dimensions])();
   else
     (*ptr_methods[FLAGS_num_dimensions])();